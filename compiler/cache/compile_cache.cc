@@ -0,0 +1,185 @@
+#include "compile_cache.hh"
+
+#include <cassert>
+#include <cstdlib>
+
+#include "../common/logger.hh"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/BLAKE3.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#ifndef LOOM_VERSION
+#define LOOM_VERSION "unknown"
+#endif
+
+// Bump when the layout of cache entries or the key changes
+static const char* const cache_format = "loom-cache-2";
+
+CompileCache::CompileCache(std::string directory)
+    : directory(std::move(directory)) {}
+
+std::string CompileCache::defaultDirectory() {
+  if (const char* env = std::getenv("LOOM_CACHE_DIR")) {
+    if (*env) {
+      return env;
+    }
+  }
+
+  llvm::SmallString<128> path;
+  if (!llvm::sys::path::cache_directory(path)) {
+    // No home directory; fall back to something per-machine
+    llvm::sys::path::system_temp_directory(/*erasedOnReboot=*/false, path);
+  }
+  llvm::sys::path::append(path, "loom");
+  return std::string(path.str());
+}
+
+const std::string* CompileCache::buildIdentity() {
+  static const std::string identity = []() {
+    // Any address inside the binary locates it where argv[0] can't
+    std::string path = llvm::sys::fs::getMainExecutable(
+        nullptr, reinterpret_cast<void*>(&CompileCache::buildIdentity));
+    llvm::sys::fs::file_status status;
+    if (path.empty() || llvm::sys::fs::status(path, status)) {
+      LOOM_WARN(
+          "[Cache] could not identify the compiler executable; not caching");
+      return std::string();
+    }
+    return path + " " + std::to_string(status.getSize()) + " " +
+           std::to_string(llvm::sys::toTimeT(status.getLastModificationTime()));
+  }();
+  return identity.empty() ? nullptr : &identity;
+}
+
+// Every field is length-prefixed so that neighbouring inputs can't be
+// shifted into each other and still produce the same hash.
+static void hashField(llvm::BLAKE3& hasher, std::string_view data) {
+  uint64_t size = data.size();
+  hasher.update(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t*>(&size), sizeof(size)));
+  hasher.update(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+}
+
+std::string CompileCache::computeKey(
+    const std::vector<std::string_view>& sources,
+    const std::string& configuration) {
+  llvm::BLAKE3 hasher;
+  hashField(hasher, cache_format);
+  hashField(hasher, LOOM_VERSION);
+  const std::string* identity = buildIdentity();
+  assert(identity && "the cache is disabled without a build identity");
+  hashField(hasher, *identity);
+  hashField(hasher, configuration);
+  // File names don't reach the output, only the contents and their order
+  hashField(hasher, std::to_string(sources.size()));
+  for (std::string_view source : sources) {
+    hashField(hasher, source);
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::string CompileCache::entryPath(const std::string& key,
+                                    const std::string& extension) const {
+  // Two-character fan-out keeps directories small on busy CI caches
+  llvm::SmallString<128> path(directory);
+  llvm::sys::path::append(path, key.substr(0, 2), key + extension);
+  return std::string(path.str());
+}
+
+bool CompileCache::lookupObject(const std::string& key,
+                                llvm::SmallVectorImpl<char>& object) const {
+  auto buffer = llvm::MemoryBuffer::getFile(entryPath(key, ".o"),
+                                            /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer) {
+    return false;
+  }
+  object.assign((*buffer)->getBufferStart(), (*buffer)->getBufferEnd());
+  LOOM_INFO("[Cache] Object file cache hit (", key, ")");
+  return true;
+}
+
+void CompileCache::storeObject(const std::string& key,
+                               llvm::ArrayRef<char> object) const {
+  writeAtomically(entryPath(key, ".o"), object, /*executable=*/false);
+}
+
+bool CompileCache::lookupExecutable(const std::string& key,
+                                    const std::string& destination) const {
+  std::string cached = entryPath(key, ".exe");
+  if (!llvm::sys::fs::exists(cached)) {
+    return false;
+  }
+  if (std::error_code EC = llvm::sys::fs::copy_file(cached, destination)) {
+    LOOM_WARN("[Cache] could not copy cached executable: ", EC.message());
+    return false;
+  }
+  llvm::sys::fs::setPermissions(destination, llvm::sys::fs::all_read |
+                                                 llvm::sys::fs::owner_write |
+                                                 llvm::sys::fs::all_exe);
+  LOOM_INFO("[Cache] Executable cache hit (", key, ")");
+  return true;
+}
+
+void CompileCache::storeExecutable(const std::string& key,
+                                   const std::string& executable) const {
+  auto buffer = llvm::MemoryBuffer::getFile(executable, /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer) {
+    LOOM_WARN("[Cache] could not read ", executable, ": ",
+              buffer.getError().message());
+    return;
+  }
+  llvm::ArrayRef<char> data((*buffer)->getBufferStart(),
+                            (*buffer)->getBufferSize());
+  writeAtomically(entryPath(key, ".exe"), data, /*executable=*/true);
+}
+
+bool CompileCache::writeAtomically(const std::string& path,
+                                   llvm::ArrayRef<char> data,
+                                   bool executable) const {
+  llvm::StringRef parent = llvm::sys::path::parent_path(path);
+  if (std::error_code EC = llvm::sys::fs::create_directories(parent)) {
+    LOOM_WARN("[Cache] could not create ", parent.str(), ": ", EC.message());
+    return false;
+  }
+
+  // Write next to the final entry, then rename over it: readers either see
+  // the old entry, no entry, or the complete new one
+  int fd;
+  llvm::SmallString<128> temp_path;
+  if (std::error_code EC = llvm::sys::fs::createUniqueFile(
+          path + ".tmp-%%%%%%%%", fd, temp_path)) {
+    LOOM_WARN("[Cache] could not create temporary file: ", EC.message());
+    return false;
+  }
+  {
+    llvm::raw_fd_ostream out(fd, /*shouldClose=*/true);
+    out.write(data.data(), data.size());
+    out.close();
+    if (out.has_error()) {
+      LOOM_WARN("[Cache] could not write ", temp_path.str().str(), ": ",
+                out.error().message());
+      out.clear_error();
+      llvm::sys::fs::remove(temp_path);
+      return false;
+    }
+  }
+
+  if (executable) {
+    llvm::sys::fs::setPermissions(temp_path, llvm::sys::fs::all_read |
+                                                 llvm::sys::fs::owner_write |
+                                                 llvm::sys::fs::all_exe);
+  }
+
+  if (std::error_code EC = llvm::sys::fs::rename(temp_path, path)) {
+    LOOM_WARN("[Cache] could not store ", path, ": ", EC.message());
+    llvm::sys::fs::remove(temp_path);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,60 @@
+// compiler/cache/compile_cache.hh
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+
+// Persistent on-disk cache of emitted objects and linked executables.
+//
+// Entries are addressed by a BLAKE3 hash over everything that influences
+// the output: the source bytes (in command-line order), the compiler
+// version and build (see buildIdentity) and the codegen configuration
+// (target triple, CPU, features, optimization level, linker). Entries are
+// written atomically, so concurrent compilers sharing a cache directory
+// never observe partial files.
+// Failing to read or write the cache is never fatal; the compiler just
+// does the work.
+class CompileCache {
+ public:
+  explicit CompileCache(std::string directory);
+
+  // $LOOM_CACHE_DIR if set, otherwise <user cache dir>/loom
+  // (e.g. ~/.cache/loom)
+  static std::string defaultDirectory();
+
+  // Path, size and modification time of the running compiler executable,
+  // so a rebuilt compiler never reuses entries of the old one (ccache's
+  // "mtime" compiler check). Taken once per process: a compile server keeps
+  // the identity of the binary it was started from. Null (and logged) if
+  // the executable can't be identified; nothing cached can be trusted to
+  // match it then, so the cache must not be used.
+  static const std::string* buildIdentity();
+
+  // Hex digest identifying one compilation. Requires buildIdentity().
+  static std::string computeKey(const std::vector<std::string_view>& sources,
+                                const std::string& configuration);
+
+  const std::string& getDirectory() const { return directory; }
+
+  bool lookupObject(const std::string& key,
+                    llvm::SmallVectorImpl<char>& object) const;
+  void storeObject(const std::string& key, llvm::ArrayRef<char> object) const;
+
+  // Copies a cached executable to destination
+  bool lookupExecutable(const std::string& key,
+                        const std::string& destination) const;
+  void storeExecutable(const std::string& key,
+                       const std::string& executable) const;
+
+ private:
+  std::string directory;
+
+  std::string entryPath(const std::string& key,
+                        const std::string& extension) const;
+  bool writeAtomically(const std::string& path, llvm::ArrayRef<char> data,
+                       bool executable) const;
+};
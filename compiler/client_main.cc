@@ -0,0 +1,51 @@
+// client_main.cc
+//
+// loom-client: forwards its command line to a running "loom --server" and
+// exits with the compilation's exit code. Output appears on the client's
+// own stdout/stderr because the server writes to the passed descriptors.
+// Without a server it falls back to running the loom compiler directly.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "driver/server_protocol.hh"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+int main(int argc, char* argv[]) {
+  std::vector<std::string> args(argv + 1, argv + argc);
+
+  int server_fd = connectToServer(defaultServerSocketPath());
+  if (server_fd >= 0) {
+    int exit_code = 1;
+    if (sendRequest(server_fd, args) &&
+        receiveExitCode(server_fd, exit_code)) {
+      return exit_code;
+    }
+    std::cerr << "Error: Lost connection to the compile server" << std::endl;
+    return 1;
+  }
+
+#ifndef _WIN32
+  // No server running: behave exactly like loom ($LOOM_COMPILER or the loom
+  // executable on PATH)
+  const char* compiler = std::getenv("LOOM_COMPILER");
+  if (!compiler || !*compiler) compiler = "loom";
+  std::vector<char*> exec_args;
+  exec_args.push_back(const_cast<char*>(compiler));
+  for (int i = 1; i < argc; ++i) {
+    exec_args.push_back(argv[i]);
+  }
+  exec_args.push_back(nullptr);
+  execvp(compiler, exec_args.data());
+  std::cerr << "Error: No compile server running and could not start '"
+            << compiler << "'" << std::endl;
+#else
+  std::cerr << "Error: No compile server running" << std::endl;
+#endif
+  return 1;
+}
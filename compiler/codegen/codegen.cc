@@ -2,76 +2,123 @@
 #include "codegen.hh"
 
 #include <iostream>
+#include <mutex>
 #include <stdexcept>
-#include <typeinfo>
 
 #include "../common/logger.hh"
+#include "../common/time_report.hh"
 #include "../parser/ast.hh"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/InlineAsm.h"
+#include "llvm/IR/PassInstrumentation.h"
+#include "llvm/IR/PassTimingInfo.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/StandardInstrumentations.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 
+#ifdef LOOM_HAS_LLD
+#include "lld/Common/Driver.h"
+LLD_HAS_DRIVER(elf)
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Names the code generator treats specially
+static const Symbol main_symbol = Symbol::intern("main");
+static const Symbol print_symbol = Symbol::intern("print");
+
 CodeGen::CodeGen() {
   context = std::make_unique<llvm::LLVMContext>();
   module = std::make_unique<llvm::Module>("MyLoomModule", *context);
   builder = std::make_unique<llvm::IRBuilder<>>(*context);
   current_function = nullptr;
+  alloca_insert_point = nullptr;
 }
 
-void CodeGen::generate(const std::vector<std::unique_ptr<StmtNode>>& ast) {
+CodeGen::~CodeGen() {
+  // The module and builder reference the context, so they have to go first
+  // (member order alone would destroy the context before the module).
+  builder.reset();
+  module.reset();
+  context.reset();
+}
+
+void CodeGen::generate(const std::vector<StmtNode*>& ast) {
   Logger::debug("Starting code generation");
 
   // Check for main function
   bool has_main_function = false;
   for (const auto& stmt : ast) {
-    if (auto* func_decl = dynamic_cast<FunctionDeclNode*>(stmt.get())) {
-      if (func_decl->name == "main") {
+    if (auto* func_decl = dyn_cast<FunctionDeclNode>(stmt)) {
+      if (func_decl->name == main_symbol) {
         has_main_function = true;
         break;
       }
     }
   }
   if (!has_main_function) {
-    Logger::error(
+    // Reported by the caller
+    throw std::runtime_error(
         "No 'main' function found in program. Every Loom program must have a "
         "main function.");
-    throw std::runtime_error("Missing main function");
   }
 
-  std::cout << "[CodeGen] Found main function in AST" << std::endl;
+  LOOM_DEBUG("[CodeGen] Found main function in AST");
 
-  std::cout << "[CodeGen] Processing " << ast.size() << " statements..."
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Processing ", ast.size(), " statements...");
 
   try {
+    // Declare all top-level functions first; the AST may be merged from
+    // several files in any order. Functions whose bodies were never parsed
+    // are unreachable and left out.
+    for (const auto& stmt : ast) {
+      auto* func_decl = dyn_cast<FunctionDeclNode>(stmt);
+      if (func_decl && !func_decl->body_pending) {
+        if (!declareFunction(*func_decl)) {
+          throw std::runtime_error("Failed to declare function: " +
+                                   func_decl->name.str());
+        }
+      }
+    }
+
     for (size_t i = 0; i < ast.size(); ++i) {
-      std::cout << "[CodeGen] Processing statement " << (i + 1) << "/"
-                << ast.size() << std::endl;
+      LOOM_DEBUG("[CodeGen] Processing statement ", (i + 1), "/", ast.size());
       codegen(*ast[i]);
-      std::cout << "[CodeGen] Statement " << (i + 1)
-                << " completed successfully" << std::endl;
+      LOOM_DEBUG("[CodeGen] Statement ", (i + 1), " completed successfully");
     }
   } catch (const std::exception& e) {
-    std::cout << "[CodeGen] Error during statement processing: " << e.what()
-              << std::endl;
-    std::cout << "[CodeGen] Printing IR so far:" << std::endl;
-    print_ir();
+    LOOM_ERROR("[CodeGen] Error during statement processing: ", e.what());
+    if (Logger::isEnabled(LogLevel::DEBUG)) {
+      LOOM_DEBUG("[CodeGen] IR so far:");
+      print_ir();
+    }
     throw;
   }
-  std::cout << "[CodeGen] Verifying function..." << std::endl;
+  LOOM_DEBUG("[CodeGen] Verifying function...");
   for (auto& function : *module) {
     llvm::verifyFunction(function);
   }
-  std::cout << "[CodeGen] Function verification completed" << std::endl;
+  LOOM_DEBUG("[CodeGen] Function verification completed");
 
-  generateEntryPoint();
+  // Under the JIT, main is called directly and returns to the host process
+  if (!jit_mode) {
+    generateEntryPoint();
+  }
 
-  std::cout << "[CodeGen] Code generation completed successfully!" << std::endl;
-  std::cout << "[CodeGen] Generated LLVM IR:" << std::endl;
-  print_ir();
+  LOOM_DEBUG("[CodeGen] Code generation completed successfully!");
 }
 
 void CodeGen::print_ir() const { module->print(llvm::outs(), nullptr); }
@@ -80,8 +127,7 @@ void CodeGen::writeIRToFile(const std::string& filename) const {
   std::error_code EC;
   llvm::raw_fd_ostream file(filename, EC);
   if (EC) {
-    std::cerr << "Error opening file " << filename << ": " << EC.message()
-              << std::endl;
+    LOOM_ERROR("Error opening file ", filename, ": ", EC.message());
     return;
   }
   module->print(file, nullptr);
@@ -91,7 +137,7 @@ void CodeGen::generateEntryPoint() {
   TargetPlatform platform = detectTargetPlatform();
 
   if (platform == TargetPlatform::Windows) {
-    std::cout << "[CodeGen] Generating Windows entry point..." << std::endl;
+    LOOM_DEBUG("[CodeGen] Generating Windows entry point...");
 
     llvm::FunctionType* entryType = llvm::FunctionType::get(
         builder->getVoidTy(),  // void return (Windows entry points return void)
@@ -135,7 +181,7 @@ void CodeGen::generateEntryPoint() {
 
   } else if (platform == TargetPlatform::Linux ||
              platform == TargetPlatform::MacOS) {
-    std::cout << "[CodeGen] Generating Unix-style entry point..." << std::endl;
+    LOOM_DEBUG("[CodeGen] Generating Unix-style entry point...");
 
     // For Linux/macOS, create _start function that calls main and then exit
     // syscall
@@ -175,15 +221,15 @@ void CodeGen::generateEntryPoint() {
     builder->CreateUnreachable();
   }
 
-  std::cout << "[CodeGen] Entry point generation completed" << std::endl;
+  LOOM_DEBUG("[CodeGen] Entry point generation completed");
 }
 
 // Platform detection based on target triple
 TargetPlatform CodeGen::detectTargetPlatform() const {
   llvm::Triple targetTriple(module->getTargetTriple());
   std::string targetTripleStr = targetTriple.str();
-  std::cout << "[CodeGen] Detecting platform from target triple: "
-            << targetTripleStr << std::endl;
+  LOOM_DEBUG("[CodeGen] Detecting platform from target triple: ",
+             targetTripleStr);
 
   if (targetTripleStr.find("windows") != std::string::npos ||
       targetTripleStr.find("win32") != std::string::npos ||
@@ -198,24 +244,24 @@ TargetPlatform CodeGen::detectTargetPlatform() const {
   }
   // Fallback: detect from preprocessor macros at compile time
 #ifdef _WIN32
-  std::cout << "[CodeGen] Defaulting to Windows platform" << std::endl;
+  LOOM_DEBUG("[CodeGen] Defaulting to Windows platform");
   return TargetPlatform::Windows;
 #elif defined(__linux__)
-  std::cout << "[CodeGen] Defaulting to Linux platform" << std::endl;
+  LOOM_DEBUG("[CodeGen] Defaulting to Linux platform");
   return TargetPlatform::Linux;
 #elif defined(__APPLE__)
-  std::cout << "[CodeGen] Defaulting to macOS platform" << std::endl;
+  LOOM_DEBUG("[CodeGen] Defaulting to macOS platform");
   return TargetPlatform::MacOS;
 #else
-  std::cout << "[CodeGen] Unknown target platform" << std::endl;
+  LOOM_DEBUG("[CodeGen] Unknown target platform");
   return TargetPlatform::Unknown;
 #endif
 }
 
 // Linux syscall implementation using inline assembly
-llvm::Value* CodeGen::generateLinuxSyscall(const std::string& name,
+llvm::Value* CodeGen::generateLinuxSyscall(std::string_view name,
                                            std::vector<llvm::Value*>& args) {
-  std::cout << "[CodeGen] Generating Linux syscall: " << name << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating Linux syscall: ", name);
 
   if (name == "print" && args.size() >= 1) {
     std::string asmStr = "syscall";
@@ -306,13 +352,13 @@ llvm::Value* CodeGen::generateLinuxSyscall(const std::string& name,
     return builder->CreateCall(inlineAsm, asmArgs, "syscall.result");
   }
 
-  throw std::runtime_error("Unsupported Linux syscall: " + name);
+  throw std::runtime_error("Unsupported Linux syscall: " + std::string(name));
 }
 
 // macOS syscall implementation using inline assembly
-llvm::Value* CodeGen::generateMacOSSyscall(const std::string& name,
+llvm::Value* CodeGen::generateMacOSSyscall(std::string_view name,
                                            std::vector<llvm::Value*>& args) {
-  std::cout << "[CodeGen] Generating macOS syscall: " << name << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating macOS syscall: ", name);
 
   if (name == "print" && args.size() >= 1) {
     // macOS write syscall: 0x2000004 (BSD syscall numbers are offset by
@@ -403,13 +449,13 @@ llvm::Value* CodeGen::generateMacOSSyscall(const std::string& name,
     return builder->CreateCall(inlineAsm, asmArgs, "syscall.result");
   }
 
-  throw std::runtime_error("Unsupported macOS syscall: " + name);
+  throw std::runtime_error("Unsupported macOS syscall: " + std::string(name));
 }
 
 // Windows syscall implementation using Windows API calls
-llvm::Value* CodeGen::generateWindowsSyscall(const std::string& name,
+llvm::Value* CodeGen::generateWindowsSyscall(std::string_view name,
                                              std::vector<llvm::Value*>& args) {
-  std::cout << "[CodeGen] Generating Windows syscall: " << name << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating Windows syscall: ", name);
   if (name == "print" && args.size() >= 1) {
     // Use WriteFile API for printing with automatic newline
     llvm::Function* writeFile = module->getFunction("WriteFile");
@@ -468,7 +514,7 @@ llvm::Value* CodeGen::generateWindowsSyscall(const std::string& name,
     }
 
     llvm::Value* bytesWritten =
-        builder->CreateAlloca(builder->getInt32Ty(), nullptr, "bytes.written");
+        createEntryBlockAlloca(builder->getInt32Ty(), "bytes.written");
 
     // First write the string content
     llvm::Value* result1 = builder->CreateCall(
@@ -482,8 +528,8 @@ llvm::Value* CodeGen::generateWindowsSyscall(const std::string& name,
     llvm::Value* newlinePtr = builder->CreatePointerCast(
         newlineStr, llvm::PointerType::getUnqual(*context));
     llvm::Value* newlineSize = builder->getInt32(1);
-    llvm::Value* bytesWritten2 = builder->CreateAlloca(
-        builder->getInt32Ty(), nullptr, "bytes.written.newline");
+    llvm::Value* bytesWritten2 =
+        createEntryBlockAlloca(builder->getInt32Ty(), "bytes.written.newline");
 
     // Write the newline (don't need to store result)
     builder->CreateCall(writeFile,
@@ -528,66 +574,66 @@ llvm::Value* CodeGen::generateWindowsSyscall(const std::string& name,
     return llvm::ConstantInt::get(builder->getInt64Ty(), -1);
   }
 
-  throw std::runtime_error("Unsupported Windows syscall: " + name);
+  throw std::runtime_error("Unsupported Windows syscall: " + std::string(name));
 }
 
 // --- Helper: AST-Typ zu LLVM-Typ ---
 llvm::Type* CodeGen::typeToLLVMType(TypeNode& type) {
-  std::cout << "[CodeGen] Converting TypeNode to LLVM type, typeid: "
-            << typeid(type).name() << std::endl;
-
-  if (auto* int_type = dynamic_cast<IntegerTypeNode*>(&type)) {
-    std::cout << "[CodeGen] Found IntegerTypeNode with bit_width: "
-              << int_type->bit_width << std::endl;
-    return builder->getIntNTy(int_type->bit_width);
-  }
-  if (auto* int_literal_type = dynamic_cast<IntegerLiteralTypeNode*>(&type)) {
-    std::cout << "[CodeGen] Found IntegerLiteralTypeNode with value: "
-              << int_literal_type->value << std::endl;
-    // For integer literals, we default to i32
-    return builder->getInt32Ty();
-  }
-  if (auto* float_type = dynamic_cast<FloatTypeNode*>(&type)) {
-    std::cout << "[CodeGen] Found FloatTypeNode with bit_width: "
-              << float_type->bit_width << std::endl;
-    switch (float_type->bit_width) {
-      case 16:
-        return builder->getHalfTy();
-      case 32:
-        return builder->getFloatTy();
-      case 64:
-        return builder->getDoubleTy();
-      default:
-        throw std::runtime_error("Unsupported float bit width");
-    }
-  }
-  if (auto* float_literal_type = dynamic_cast<FloatLiteralTypeNode*>(&type)) {
-    std::cout << "[CodeGen] Found FloatLiteralTypeNode with value: "
-              << float_literal_type->value << std::endl;
-    // For float literals, we default to double (f64)
-    return builder->getDoubleTy();
-  }
-  if (dynamic_cast<BooleanTypeNode*>(&type)) {
-    std::cout << "[CodeGen] Found BooleanTypeNode" << std::endl;
-    return builder->getInt1Ty();  // bool wird als 1-bit Integer dargestellt
-  }
-  if (dynamic_cast<StringTypeNode*>(&type)) {
-    std::cout << "[CodeGen] Found StringTypeNode" << std::endl;
-    // Strings werden oft als Zeiger auf ein Char-Array (i8*) dargestellt
-    // In newer LLVM versions, use getPtrTy() for opaque pointers
-    return llvm::PointerType::getUnqual(*context);
+  LOOM_DEBUG("[CodeGen] Converting TypeNode to LLVM type: ", type.toString());
+
+  switch (type.getKind()) {
+    case NodeKind::IntegerTypeNode:
+      return builder->getIntNTy(cast<IntegerTypeNode>(&type)->bit_width);
+    case NodeKind::IntegerLiteralTypeNode:
+      // For integer literals, we default to i32
+      return builder->getInt32Ty();
+    case NodeKind::FloatTypeNode:
+      switch (cast<FloatTypeNode>(&type)->bit_width) {
+        case 16:
+          return builder->getHalfTy();
+        case 32:
+          return builder->getFloatTy();
+        case 64:
+          return builder->getDoubleTy();
+        default:
+          throw std::runtime_error("Unsupported float bit width");
+      }
+    case NodeKind::FloatLiteralTypeNode:
+      // For float literals, we default to double (f64)
+      return builder->getDoubleTy();
+    case NodeKind::BooleanTypeNode:
+      return builder->getInt1Ty();  // bool wird als 1-bit Integer dargestellt
+    case NodeKind::StringTypeNode:
+      // Strings werden oft als Zeiger auf ein Char-Array (i8*) dargestellt
+      // In newer LLVM versions, use getPtrTy() for opaque pointers
+      return llvm::PointerType::getUnqual(*context);
+    default:
+      break;
   }
 
-  std::cout << "[CodeGen] ERROR: Unknown TypeNode, type info: "
-            << typeid(type).name() << std::endl;
+  LOOM_ERROR("[CodeGen] Unknown TypeNode: ", type.toString());
   throw std::runtime_error("Unknown TypeNode for CodeGen");
 }
 
+// --- Helper: Entry-block stack slots ---
+llvm::AllocaInst* CodeGen::createEntryBlockAlloca(llvm::Type* type,
+                                                  const std::string& name) {
+  if (!alloca_insert_point) {
+    // Not inside a function body, fall back to the current insertion point
+    return builder->CreateAlloca(type, nullptr, name);
+  }
+
+  // Allocas emitted at the current insertion point would re-allocate on
+  // every loop iteration and are invisible to mem2reg; keep them all in the
+  // entry block instead.
+  llvm::IRBuilder<> entry_builder(alloca_insert_point);
+  return entry_builder.CreateAlloca(type, nullptr, name);
+}
+
 // --- Helper: Generate code with target type for casting ---
 llvm::Value* CodeGen::codegenWithTargetType(ASTNode& node,
                                             llvm::Type* targetType) {
-  std::cout << "[CodeGen] Generating node with target type casting"
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating node with target type casting");
 
   // Generate the base value
   llvm::Value* baseValue = codegen(node);
@@ -597,14 +643,13 @@ llvm::Value* CodeGen::codegenWithTargetType(ASTNode& node,
 
   // If types match, return as-is
   if (baseValue->getType() == targetType) {
-    std::cout << "[CodeGen] Types already match, no casting needed"
-              << std::endl;
+    LOOM_DEBUG("[CodeGen] Types already match, no casting needed");
     return baseValue;
   }
 
   // Cast integer types
   if (baseValue->getType()->isIntegerTy() && targetType->isIntegerTy()) {
-    std::cout << "[CodeGen] Casting between integer types" << std::endl;
+    LOOM_DEBUG("[CodeGen] Casting between integer types");
 
     auto* baseIntType = llvm::cast<llvm::IntegerType>(baseValue->getType());
     auto* targetIntType = llvm::cast<llvm::IntegerType>(targetType);
@@ -621,118 +666,94 @@ llvm::Value* CodeGen::codegenWithTargetType(ASTNode& node,
   // Cast float types
   if (baseValue->getType()->isFloatingPointTy() &&
       targetType->isFloatingPointTy()) {
-    std::cout << "[CodeGen] Casting between float types" << std::endl;
+    LOOM_DEBUG("[CodeGen] Casting between float types");
     return builder->CreateFPCast(baseValue, targetType, "fpcast");
   }
 
   // Integer to float
   if (baseValue->getType()->isIntegerTy() && targetType->isFloatingPointTy()) {
-    std::cout << "[CodeGen] Casting integer to float" << std::endl;
+    LOOM_DEBUG("[CodeGen] Casting integer to float");
     return builder->CreateSIToFP(baseValue, targetType, "sitofp");
   }
 
   // Float to integer
   if (baseValue->getType()->isFloatingPointTy() && targetType->isIntegerTy()) {
-    std::cout << "[CodeGen] Casting float to integer" << std::endl;
+    LOOM_DEBUG("[CodeGen] Casting float to integer");
     return builder->CreateFPToSI(baseValue, targetType, "fptosi");
   }
 
-  std::cout << "[CodeGen] ERROR: Unsupported type casting" << std::endl;
+  LOOM_ERROR("[CodeGen] Unsupported type casting");
   throw std::runtime_error("Unsupported type casting in codegenWithTargetType");
 }
 
 // --- Codegen Dispatch ---
 llvm::Value* CodeGen::codegen(ASTNode& node) {
-  std::cout << "[CodeGen] Dispatching node: " << node.toString() << std::endl;
-  // Die Reihenfolge ist wichtig: von spezifisch zu allgemein
-  if (auto* n = dynamic_cast<VarDeclNode*>(&node)) {
-    std::cout << "[CodeGen] Processing VarDeclNode" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<IfStmtNode*>(&node)) {
-    std::cout << "[CodeGen] Processing IfStmtNode" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<WhileStmtNode*>(&node)) {
-    std::cout << "[CodeGen] Processing WhileStmtNode" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<ExprStmtNode*>(&node)) {
-    std::cout << "[CodeGen] Processing ExprStmtNode" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<AssignmentExpr*>(&node)) {
-    std::cout << "[CodeGen] Processing AssignmentExpr" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<FunctionCallExpr*>(&node)) {
-    std::cout << "[CodeGen] Processing FunctionCallExpr" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<BuiltinCallExpr*>(&node)) {
-    std::cout << "[CodeGen] Processing BuiltinCallExpr" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<FunctionDeclNode*>(&node)) {
-    std::cout << "[CodeGen] Processing FunctionDeclNode" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<ReturnStmtNode*>(&node)) {
-    std::cout << "[CodeGen] Processing ReturnStmtNode" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<BinaryExpr*>(&node)) {
-    std::cout << "[CodeGen] Processing BinaryExpr" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<Identifier*>(&node)) {
-    std::cout << "[CodeGen] Processing Identifier" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<NumberLiteral*>(&node)) {
-    std::cout << "[CodeGen] Processing NumberLiteral" << std::endl;
-    return codegen(*n);
-  }
-  if (auto* n = dynamic_cast<StringLiteral*>(&node)) {
-    std::cout << "[CodeGen] Processing StringLiteral" << std::endl;
-    return codegen(*n);
+  LOOM_DEBUG("[CodeGen] Dispatching node: ", node.toString());
+  switch (node.getKind()) {
+    case NodeKind::VarDeclNode:
+      return codegen(*cast<VarDeclNode>(&node));
+    case NodeKind::IfStmtNode:
+      return codegen(*cast<IfStmtNode>(&node));
+    case NodeKind::WhileStmtNode:
+      return codegen(*cast<WhileStmtNode>(&node));
+    case NodeKind::ExprStmtNode:
+      return codegen(*cast<ExprStmtNode>(&node));
+    case NodeKind::AssignmentExpr:
+      return codegen(*cast<AssignmentExpr>(&node));
+    case NodeKind::FunctionCallExpr:
+      return codegen(*cast<FunctionCallExpr>(&node));
+    case NodeKind::BuiltinCallExpr:
+      return codegen(*cast<BuiltinCallExpr>(&node));
+    case NodeKind::FunctionDeclNode:
+      return codegen(*cast<FunctionDeclNode>(&node));
+    case NodeKind::ReturnStmtNode:
+      return codegen(*cast<ReturnStmtNode>(&node));
+    case NodeKind::BinaryExpr:
+      return codegen(*cast<BinaryExpr>(&node));
+    case NodeKind::Identifier:
+      return codegen(*cast<Identifier>(&node));
+    case NodeKind::NumberLiteral:
+      return codegen(*cast<NumberLiteral>(&node));
+    case NodeKind::StringLiteral:
+      return codegen(*cast<StringLiteral>(&node));
+    default:
+      // ... weitere Knotentypen hier einfügen
+      break;
   }
-  // ... weitere Knotentypen hier einfügen
 
-  std::cout << "[CodeGen] ERROR: No codegen implementation for node type: "
-            << node.toString() << std::endl;
+  LOOM_ERROR("[CodeGen] No codegen implementation for node type: ",
+             node.toString());
   throw std::runtime_error("CodeGen not implemented for this ASTNode type: " +
                            node.toString());
 }
 
 // --- Codegen für Literale ---
 llvm::Value* CodeGen::codegen(NumberLiteral& node) {
-  std::cout << "[CodeGen] Generating NumberLiteral: " << node.value
-            << " (is_float: " << node.is_float << ")" << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating NumberLiteral: ", node.toString());
 
   if (node.is_float) {
-    double val = std::stod(node.value);
-    std::cout << "[CodeGen] Creating float constant: " << val << std::endl;
+    double val = node.float_value;
+    LOOM_DEBUG("[CodeGen] Creating float constant: ", val);
     // TODO: Hier müsste man den Typ genauer bestimmen (f32, f64 etc.)
     // Fürs Erste nehmen wir immer f64 (double).
     return llvm::ConstantFP::get(*context, llvm::APFloat(val));
   } else {
-    long long val = std::stoll(node.value);
-    std::cout << "[CodeGen] Creating int constant: " << val
-              << std::endl;  // TODO: Hier müsste man den Typ genauer bestimmen
-                             // (i32, i64 etc.)
-    // Fürs Erste nehmen wir immer i32.
-    return llvm::ConstantInt::get(
-        *context, llvm::APInt(32, static_cast<uint64_t>(val), true));
+    uint64_t val = node.int_value;
+    // TODO: Hier müsste man den Typ genauer bestimmen (i32, i64 etc.)
+    LOOM_DEBUG("[CodeGen] Creating int constant: ", val);
+    // i32 unless the value needs more; sema has checked that it fits the
+    // declared type, and codegenWithTargetType narrows it to that
+    const unsigned bit_width = val <= INT32_MAX ? 32 : 64;
+    return llvm::ConstantInt::get(*context,
+                                  llvm::APInt(bit_width, val, false));
   }
 }
 
 llvm::Value* CodeGen::codegen(StringLiteral& node) {
-  std::cout << "[CodeGen] Generating StringLiteral: \"" << node.value << "\""
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating StringLiteral: \"", node.value, "\"");
 
   // Remove quotes from the string value
-  std::string str_value = node.value;
+  std::string str_value(node.value);
   if (str_value.size() >= 2 && str_value.front() == '"' &&
       str_value.back() == '"') {
     str_value = str_value.substr(1, str_value.size() - 2);
@@ -756,61 +777,56 @@ llvm::Value* CodeGen::codegen(StringLiteral& node) {
   llvm::Value* strPtr = builder->CreateInBoundsGEP(
       strConstant->getType(), globalStr, indices, "str.ptr");
 
-  std::cout << "[CodeGen] String constant created successfully" << std::endl;
+  LOOM_DEBUG("[CodeGen] String constant created successfully");
   return strPtr;
 }
 
 // --- Codegen für Statements ---
 llvm::Value* CodeGen::codegen(VarDeclNode& node) {
-  std::cout << "[CodeGen] Generating VarDeclNode: " << node.name << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating VarDeclNode: ", node.name);
 
   // Check if type is null
   if (node.type == nullptr) {
-    std::cout << "[CodeGen] ERROR: node.type is nullptr for variable: "
-              << node.name << std::endl;
-    throw std::runtime_error("Type is null for variable: " + node.name);
+    LOOM_ERROR("[CodeGen] node.type is nullptr for variable: ", node.name);
+    throw std::runtime_error("Type is null for variable: " + node.name.str());
   }
 
   // 2. Bestimme den LLVM-Typ der Variable aus dem AST-Typknoten.
-  std::cout << "[CodeGen] Determining LLVM type for variable: " << node.name
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Determining LLVM type for variable: ", node.name);
   llvm::Type* varType = typeToLLVMType(*node.type);
-  std::cout << "[CodeGen] LLVM type determined successfully" << std::endl;
+  LOOM_DEBUG("[CodeGen] LLVM type determined successfully");
 
   // 1. Generiere den Code für den Initialisierungswert mit dem richtigen Typ.
-  std::cout << "[CodeGen] Generating initializer for variable: " << node.name
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating initializer for variable: ", node.name);
   llvm::Value* initializerVal =
       codegenWithTargetType(*node.initializer, varType);
-  std::cout << "[CodeGen] Initializer generated successfully" << std::endl;
+  LOOM_DEBUG("[CodeGen] Initializer generated successfully");
 
   // 3. Erzeuge eine 'alloca'-Instruktion.
-  std::cout << "[CodeGen] Creating alloca for variable: " << node.name
-            << std::endl;
-  llvm::Value* alloca = builder->CreateAlloca(varType, nullptr, node.name);
-  std::cout << "[CodeGen] Alloca created successfully" << std::endl;
+  LOOM_DEBUG("[CodeGen] Creating alloca for variable: ", node.name);
+  llvm::Value* alloca = createEntryBlockAlloca(varType, node.name.str());
+  LOOM_DEBUG("[CodeGen] Alloca created successfully");
 
   // 4. Speichere den Initialisierungswert in dem reservierten Speicher.
-  std::cout << "[CodeGen] Storing initializer value in alloca" << std::endl;
+  LOOM_DEBUG("[CodeGen] Storing initializer value in alloca");
   builder->CreateStore(initializerVal, alloca);
-  std::cout << "[CodeGen] Store instruction created successfully" << std::endl;
+  LOOM_DEBUG("[CodeGen] Store instruction created successfully");
   // 5. Merke dir den Speicherort der Variable in unserer "Symboltabelle".
   named_values[node.name] = alloca;
   variable_types[node.name] =
       varType;  // Store the type for opaque pointer support
-  std::cout << "[CodeGen] Variable " << node.name << " added to symbol table"
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Variable ", node.name, " added to symbol table");
 
   return nullptr;
 }
 
 llvm::Value* CodeGen::codegen(Identifier& node) {
-  std::cout << "[CodeGen] Generating Identifier: " << node.name << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating Identifier: ", node.name);
   // 1. Suche die Variable in unserer Symboltabelle.
   auto it = named_values.find(node.name);
   if (it == named_values.end()) {
-    throw std::runtime_error("CodeGen: Unknown variable name '" + node.name +
-                             "'.");
+    throw std::runtime_error("CodeGen: Unknown variable name '" +
+                             node.name.str() + "'.");
   }
 
   // it->second ist der Zeiger auf den Stack-Speicher (das Ergebnis von alloca).
@@ -820,15 +836,15 @@ llvm::Value* CodeGen::codegen(Identifier& node) {
   auto type_it = variable_types.find(node.name);
   if (type_it == variable_types.end()) {
     throw std::runtime_error("CodeGen: Unknown variable type for '" +
-                             node.name + "'.");
+                             node.name.str() + "'.");
   }
 
   llvm::Type* var_type = type_it->second;
-  return builder->CreateLoad(var_type, var_ptr, node.name + ".load");
+  return builder->CreateLoad(var_type, var_ptr, node.name.str() + ".load");
 }
 
 llvm::Value* CodeGen::codegen(BinaryExpr& node) {
-  std::cout << "[CodeGen] Generating BinaryExpr" << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating BinaryExpr");
   // 1. Rekursiv den Code für die linke und rechte Seite generieren.
   llvm::Value* L = codegen(*node.left);
   llvm::Value* R = codegen(*node.right);
@@ -846,7 +862,7 @@ llvm::Value* CodeGen::codegen(BinaryExpr& node) {
     if (R->getType()->isIntegerTy()) {
       R = builder->CreateSIToFP(R, builder->getDoubleTy(), "int2fp");
     }  // Generate floating point operations
-    switch (node.op.type) {
+    switch (node.op) {
       case TokenType::TOKEN_PLUS:
         return builder->CreateFAdd(L, R, "fadd.tmp");
       case TokenType::TOKEN_MINUS:
@@ -869,7 +885,16 @@ llvm::Value* CodeGen::codegen(BinaryExpr& node) {
         throw std::runtime_error("CodeGen: Unknown binary operator for float.");
     }
   } else {  // Both operands are integers - generate integer operations
-    switch (node.op.type) {
+    // A literal too large for i32 is an i64 constant (see NumberLiteral);
+    // it takes the other operand's type, which sema has checked it fits
+    if (L->getType() != R->getType()) {
+      if (llvm::isa<llvm::ConstantInt>(R)) {
+        R = builder->CreateIntCast(R, L->getType(), true, "int.cast");
+      } else if (llvm::isa<llvm::ConstantInt>(L)) {
+        L = builder->CreateIntCast(L, R->getType(), true, "int.cast");
+      }
+    }
+    switch (node.op) {
       case TokenType::TOKEN_PLUS:
         return builder->CreateAdd(L, R, "add.tmp");
       case TokenType::TOKEN_MINUS:
@@ -897,7 +922,7 @@ llvm::Value* CodeGen::codegen(BinaryExpr& node) {
 }
 
 llvm::Value* CodeGen::codegen(IfStmtNode& node) {
-  std::cout << "[CodeGen] Generating IfStmtNode" << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating IfStmtNode");
 
   // Generate condition
   llvm::Value* condition_val = codegen(*node.condition);
@@ -950,7 +975,7 @@ llvm::Value* CodeGen::codegen(IfStmtNode& node) {
 }
 
 llvm::Value* CodeGen::codegen(WhileStmtNode& node) {
-  std::cout << "[CodeGen] Generating WhileStmtNode" << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating WhileStmtNode");
 
   // Get current function
   llvm::Function* current_function = builder->GetInsertBlock()->getParent();
@@ -1000,7 +1025,7 @@ llvm::Value* CodeGen::codegen(WhileStmtNode& node) {
 }
 
 llvm::Value* CodeGen::codegen(ExprStmtNode& node) {
-  std::cout << "[CodeGen] Generating ExprStmtNode" << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating ExprStmtNode");
 
   // For expression statements, we just evaluate the expression
   // The result value is not used, but the expression may have side effects
@@ -1009,8 +1034,7 @@ llvm::Value* CodeGen::codegen(ExprStmtNode& node) {
 }
 
 llvm::Value* CodeGen::codegen(AssignmentExpr& node) {
-  std::cout << "[CodeGen] Generating AssignmentExpr: " << node.name
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating AssignmentExpr: ", node.name);
 
   // Generate the value to assign
   llvm::Value* value = codegen(*node.value);
@@ -1019,9 +1043,8 @@ llvm::Value* CodeGen::codegen(AssignmentExpr& node) {
   // Find the variable in the symbol table
   auto it = named_values.find(node.name);
   if (it == named_values.end()) {
-    std::cout << "[CodeGen] ERROR: Undefined variable: " << node.name
-              << std::endl;
-    throw std::runtime_error("Undefined variable: " + node.name);
+    LOOM_ERROR("[CodeGen] Undefined variable: ", node.name);
+    throw std::runtime_error("Undefined variable: " + node.name.str());
   }
 
   llvm::Value* variable_ptr = it->second;
@@ -1029,17 +1052,15 @@ llvm::Value* CodeGen::codegen(AssignmentExpr& node) {
   // Store the new value
   builder->CreateStore(value, variable_ptr);
 
-  std::cout << "[CodeGen] Assignment completed for variable: " << node.name
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Assignment completed for variable: ", node.name);
   return value;  // Return the assigned value
 }
 
 llvm::Value* CodeGen::codegen(FunctionCallExpr& node) {
-  std::cout << "[CodeGen] Generating FunctionCallExpr: " << node.function_name
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating FunctionCallExpr: ", node.function_name);
 
   // Handle built-in functions
-  if (node.function_name == "print") {
+  if (node.function_name == print_symbol) {
     // Declare printf if not already declared
     llvm::Function* printf_func = module->getFunction("printf");
     if (!printf_func) {
@@ -1091,11 +1112,11 @@ llvm::Value* CodeGen::codegen(FunctionCallExpr& node) {
   }
 
   // Handle user-defined functions
-  llvm::Function* target_func = module->getFunction(node.function_name);
+  llvm::Function* target_func = module->getFunction(node.function_name.str());
   if (!target_func) {
-    std::cout << "[CodeGen] ERROR: Function '" << node.function_name
-              << "' not found in module" << std::endl;
-    throw std::runtime_error("Function not found: " + node.function_name);
+    LOOM_ERROR("[CodeGen] Function '", node.function_name,
+               "' not found in module");
+    throw std::runtime_error("Function not found: " + node.function_name.str());
   }
 
   // Generate arguments
@@ -1103,9 +1124,7 @@ llvm::Value* CodeGen::codegen(FunctionCallExpr& node) {
   for (auto& arg_node : node.arguments) {
     llvm::Value* arg_value = codegen(*arg_node);
     if (!arg_value) {
-      std::cout
-          << "[CodeGen] ERROR: Failed to generate argument for function call"
-          << std::endl;
+      LOOM_ERROR("[CodeGen] Failed to generate argument for function call");
       return nullptr;
     }
     args.push_back(arg_value);
@@ -1113,22 +1132,21 @@ llvm::Value* CodeGen::codegen(FunctionCallExpr& node) {
 
   // Verify argument count matches function signature
   if (args.size() != target_func->arg_size()) {
-    std::cout << "[CodeGen] ERROR: Argument count mismatch. Expected "
-              << target_func->arg_size() << ", got " << args.size()
-              << std::endl;
+    LOOM_ERROR("[CodeGen] Argument count mismatch. Expected ",
+               target_func->arg_size(), ", got ", args.size());
     throw std::runtime_error("Argument count mismatch for function: " +
-                             node.function_name);
+                             node.function_name.str());
   }
 
   // Create function call
-  std::cout << "[CodeGen] Creating call to function: " << node.function_name
-            << " with " << args.size() << " arguments" << std::endl;
-  return builder->CreateCall(target_func, args, node.function_name + ".call");
+  LOOM_DEBUG("[CodeGen] Creating call to function: ", node.function_name,
+             " with ", args.size(), " arguments");
+  return builder->CreateCall(target_func, args,
+                             node.function_name.str() + ".call");
 }
 
 llvm::Value* CodeGen::codegen(BuiltinCallExpr& node) {
-  std::cout << "[CodeGen] Generating BuiltinCallExpr: $$" << node.builtin_name
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating BuiltinCallExpr: $$", node.builtin_name);
 
   // Detect target platform for cross-platform support
   TargetPlatform platform = detectTargetPlatform();
@@ -1163,11 +1181,11 @@ llvm::Value* CodeGen::codegen(BuiltinCallExpr& node) {
         return generateWindowsSyscall(node.builtin_name, args);
       default:
         throw std::runtime_error("Unsupported target platform for builtin: " +
-                                 node.builtin_name);
+                                 std::string(node.builtin_name));
     }
   } catch (const std::exception& e) {
-    std::cout << "[CodeGen] Error generating builtin $$" << node.builtin_name
-              << ": " << e.what() << std::endl;
+    LOOM_ERROR("[CodeGen] Error generating builtin $$", node.builtin_name, ": ",
+               e.what());
     throw;
   }
 }
@@ -1175,154 +1193,449 @@ llvm::Value* CodeGen::codegen(BuiltinCallExpr& node) {
 // --- Integrated Compilation Methods (like Kaleidoscope) ---
 
 bool CodeGen::initializeLLVMTargets() {
-  // Initialize all targets for code generation
-  llvm::InitializeAllTargetInfos();
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmParsers();
-  llvm::InitializeAllAsmPrinters();
-
-  std::cout << "[CodeGen] LLVM targets initialized successfully" << std::endl;
+  // Initialize all targets for code generation. Only the first call does
+  // the work; the compile server calls this once at startup.
+  static std::once_flag targets_initialized;
+  std::call_once(targets_initialized, []() {
+    llvm::InitializeAllTargetInfos();
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmParsers();
+    llvm::InitializeAllAsmPrinters();
+  });
+
+  LOOM_DEBUG("[CodeGen] LLVM targets initialized successfully");
   return true;
 }
 
-bool CodeGen::compileToObjectFile(const std::string& filename) const {
-  std::cout << "[CodeGen] Compiling to object file: " << filename << std::endl;
-
+std::string CodeGen::getTargetTripleString() const {
   // Get target triple based on platform
-  std::string targetTripleStr;
-  TargetPlatform platform = detectTargetPlatform();
-
-  switch (platform) {
+  switch (detectTargetPlatform()) {
     case TargetPlatform::Windows:
-      targetTripleStr = "x86_64-pc-windows-msvc";
-      break;
+      return "x86_64-pc-windows-msvc";
     case TargetPlatform::Linux:
-      targetTripleStr = "x86_64-pc-linux-gnu";
-      break;
+      return "x86_64-pc-linux-gnu";
     case TargetPlatform::MacOS:
-      targetTripleStr = "x86_64-apple-darwin";
-      break;
+      return "x86_64-apple-darwin";
     default:
       // Fallback to platform-specific defaults
 #ifdef _WIN32
-      targetTripleStr = "x86_64-pc-windows-msvc";
+      return "x86_64-pc-windows-msvc";
 #elif defined(__linux__)
-      targetTripleStr = "x86_64-pc-linux-gnu";
+      return "x86_64-pc-linux-gnu";
 #elif defined(__APPLE__)
-      targetTripleStr = "x86_64-apple-darwin";
+      return "x86_64-apple-darwin";
 #else
-      targetTripleStr = "x86_64-unknown-unknown";
+      return "x86_64-unknown-unknown";
 #endif
-      break;
   }
+}
 
-  std::cout << "[CodeGen] Using target triple: " << targetTripleStr
-            << std::endl;
+// CPU and feature string passed to every TargetMachine
+static const char* const target_cpu = "generic";
+static const char* const target_features = "";
+
+static llvm::CodeGenOptLevel toCodeGenOptLevel(OptLevel level) {
+  switch (level) {
+    case OptLevel::O0:
+      return llvm::CodeGenOptLevel::None;
+    case OptLevel::O1:
+      return llvm::CodeGenOptLevel::Less;
+    case OptLevel::O3:
+      return llvm::CodeGenOptLevel::Aggressive;
+    case OptLevel::O2:
+    case OptLevel::Os:
+    default:
+      return llvm::CodeGenOptLevel::Default;
+  }
+}
 
-  llvm::Triple targetTriple(targetTripleStr);
-  module->setTargetTriple(targetTriple);
+static llvm::OptimizationLevel toPassBuilderOptLevel(OptLevel level) {
+  switch (level) {
+    case OptLevel::O0:
+      return llvm::OptimizationLevel::O0;
+    case OptLevel::O1:
+      return llvm::OptimizationLevel::O1;
+    case OptLevel::O3:
+      return llvm::OptimizationLevel::O3;
+    case OptLevel::Os:
+      return llvm::OptimizationLevel::Os;
+    case OptLevel::O2:
+    default:
+      return llvm::OptimizationLevel::O2;
+  }
+}
+
+std::string CodeGen::getTargetDescription() const {
+  return getTargetTripleString() + " " + target_cpu + " " + target_features +
+         " O" + std::to_string(static_cast<int>(opt_level));
+}
+
+std::unique_ptr<llvm::TargetMachine> CodeGen::createTargetMachine(
+    const std::string& target_triple) const {
+  llvm::Triple targetTriple(target_triple);
   std::string error;
-  auto target = llvm::TargetRegistry::lookupTarget(targetTripleStr, error);
+  auto target = llvm::TargetRegistry::lookupTarget(target_triple, error);
 
   if (!target) {
-    std::cerr << "[CodeGen] Error: " << error << std::endl;
-    return false;
+    LOOM_ERROR("[CodeGen] ", error);
+    return nullptr;
   }
-  auto CPU = "generic";
-  auto features = "";
+  auto CPU = target_cpu;
+  auto features = target_features;
 
   llvm::TargetOptions opt;
   auto relocationModel = llvm::Reloc::PIC_;
-  auto targetMachine = target->createTargetMachine(targetTriple, CPU, features,
-                                                   opt, relocationModel);
+  return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(
+      targetTriple, CPU, features, opt, relocationModel, std::nullopt,
+      toCodeGenOptLevel(opt_level)));
+}
 
-  module->setDataLayout(targetMachine->createDataLayout());
+llvm::TargetMachine* CodeGen::getTargetMachine(
+    const std::string& target_triple) const {
+  // TargetMachines are expensive to build and only depend on the triple and
+  // the optimization level, so they are kept for the life of the process
+  // (which, for the compile server, spans many compilations)
+  static std::mutex cache_mutex;
+  static std::map<std::pair<std::string, OptLevel>,
+                  std::unique_ptr<llvm::TargetMachine>>
+      target_machines;
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  auto& target_machine = target_machines[{target_triple, opt_level}];
+  if (!target_machine) {
+    target_machine = createTargetMachine(target_triple);
+  }
+  return target_machine.get();
+}
 
-  std::error_code EC;
-  llvm::raw_fd_ostream dest(filename, EC, llvm::sys::fs::OF_None);
+bool CodeGen::preloadTargetMachine() const {
+  return getTargetMachine(getTargetTripleString()) != nullptr;
+}
 
-  if (EC) {
-    std::cerr << "[CodeGen] Could not open file: " << EC.message() << std::endl;
+void CodeGen::optimizeModule(llvm::TargetMachine& target_machine) const {
+  LOOM_DEBUG("[CodeGen] Running optimization pipeline");
+  TimeReport::Scope time_scope("LLVM optimization");
+
+  // Per-pass timings for --time-report
+  llvm::PassInstrumentationCallbacks PIC;
+  std::string pass_report;
+  llvm::raw_string_ostream pass_report_stream(pass_report);
+  llvm::TimePassesHandler time_passes(TimeReport::isEnabled());
+  time_passes.setOutStream(pass_report_stream);
+  time_passes.registerCallbacks(PIC);
+  // Per-pass --time-trace events (no-op unless the profiler is running)
+  llvm::TimeProfilingPassesHandler time_profiling;
+  time_profiling.registerCallbacks(PIC);
+
+  llvm::LoopAnalysisManager LAM;
+  llvm::FunctionAnalysisManager FAM;
+  llvm::CGSCCAnalysisManager CGAM;
+  llvm::ModuleAnalysisManager MAM;
+
+  // Hooking in the TargetMachine gives the pipeline real cost models
+  // (TargetTransformInfo) instead of the generic defaults.
+  llvm::PassBuilder PB(&target_machine, llvm::PipelineTuningOptions(),
+                       std::nullopt, &PIC);
+
+  // Loom executables are freestanding (linked with -nostdlib), so the
+  // optimizer must not turn loops or calls into libc functions it assumes
+  // to exist (memset, memcpy, puts, ...). Registered before the defaults.
+  llvm::TargetLibraryInfoImpl TLII(target_machine.getTargetTriple());
+  TLII.disableAllFunctions();
+  FAM.registerPass([&] { return llvm::TargetLibraryAnalysis(TLII); });
+
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  if (opt_level == OptLevel::Os) {
+    for (auto& function : *module) {
+      if (!function.isDeclaration()) {
+        function.addFnAttr(llvm::Attribute::OptimizeForSize);
+      }
+    }
+  }
+
+  llvm::ModulePassManager MPM;
+  if (opt_level == OptLevel::O0) {
+    MPM = PB.buildO0DefaultPipeline(llvm::OptimizationLevel::O0);
+  } else {
+    MPM = PB.buildPerModuleDefaultPipeline(toPassBuilderOptLevel(opt_level));
+  }
+  MPM.run(*module, MAM);
+
+  if (TimeReport::isEnabled()) {
+    time_passes.print();
+    TimeReport::addLLVMPassReport(pass_report_stream.str());
+  }
+}
+
+bool CodeGen::compileToObjectFile(llvm::SmallVectorImpl<char>& object) const {
+  LOOM_DEBUG("[CodeGen] Compiling to in-memory object file");
+
+  std::string targetTripleStr = getTargetTripleString();
+  LOOM_DEBUG("[CodeGen] Using target triple: ", targetTripleStr);
+
+  llvm::Triple targetTriple(targetTripleStr);
+  module->setTargetTriple(targetTriple);
+
+  llvm::TargetMachine* targetMachine = getTargetMachine(targetTripleStr);
+  if (!targetMachine) {
     return false;
   }
 
+  module->setDataLayout(targetMachine->createDataLayout());
+
+  optimizeModule(*targetMachine);
+
+  object.clear();
+  llvm::raw_svector_ostream dest(object);
+
+  TimeReport::Scope time_scope("Object emission");
   llvm::legacy::PassManager pass;
   auto fileType = llvm::CodeGenFileType::ObjectFile;
 
   if (targetMachine->addPassesToEmitFile(pass, dest, nullptr, fileType)) {
-    std::cerr << "[CodeGen] TargetMachine can't emit a file of this type"
-              << std::endl;
+    LOOM_ERROR("[CodeGen] TargetMachine can't emit a file of this type");
     return false;
   }
 
   pass.run(*module);
-  dest.flush();
 
-  std::cout << "[CodeGen] Successfully wrote object file: " << filename
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Successfully generated object file (", object.size(),
+             " bytes)");
   return true;
 }
 
-bool CodeGen::compileToExecutable(const std::string& objectFilename,
-                                  const std::string& executableFilename) const {
-  std::cout << "[CodeGen] Linking object file to executable..." << std::endl;
-
-  // Detect platform for cross-platform linking
-  TargetPlatform platform = detectTargetPlatform();
-  std::string linkCmd;
+// Extra clang driver flags for linking a freestanding executable
+static const char* clangLinkFlags(TargetPlatform platform) {
   switch (platform) {
     case TargetPlatform::Windows:
       // Windows: Use clang with minimal runtime support
       // Include compiler-rt for __chkstk and other compiler builtins
-      linkCmd = "clang \"" + objectFilename + "\" -o \"" + executableFilename +
-                "\" -nostdlib -lkernel32 -lmsvcrt";
-      break;
-
+      return " -nostdlib -lkernel32 -lmsvcrt";
     case TargetPlatform::Linux:
       // Linux: Use clang with no libc, link for Linux syscalls
-      linkCmd = "clang \"" + objectFilename + "\" -o \"" + executableFilename +
-                "\" -nostdlib -static";
-      break;
-
+      return " -nostdlib -static";
     case TargetPlatform::MacOS:
       // macOS: Use clang with no libc, link for macOS syscalls
-      linkCmd = "clang \"" + objectFilename + "\" -o \"" + executableFilename +
-                "\" -nostdlib -static";
-      break;
-
+      return " -nostdlib -static";
     default:
       // Fallback: Use standard linking
-      linkCmd =
-          "clang \"" + objectFilename + "\" -o \"" + executableFilename + "\"";
-      break;
+      return "";
   }
+}
+
+std::string CodeGen::getLinkerDescription() const {
+  TargetPlatform platform = detectTargetPlatform();
+#ifdef LOOM_HAS_LLD
+  if (platform == TargetPlatform::Linux) {
+    return "lld -static";
+  }
+#endif
+  // Whichever clang is first on PATH links, so its location is part of it
+  auto clang = llvm::sys::findProgramByName("clang");
+  return (clang ? *clang : std::string("clang")) + clangLinkFlags(platform);
+}
 
-  std::cout << "[CodeGen] Running linker: " << linkCmd << std::endl;
+bool CodeGen::compileToExecutable(const llvm::SmallVectorImpl<char>& object,
+                                  const std::string& executableFilename) const {
+  LOOM_DEBUG("[CodeGen] Linking object file to executable...");
+  TimeReport::Scope time_scope("Linking");
+
+#ifdef LOOM_HAS_LLD
+  if (detectTargetPlatform() == TargetPlatform::Linux) {
+    return linkWithLLD(object, executableFilename);
+  }
+#endif
+  return linkWithClangDriver(object, executableFilename);
+}
+
+bool CodeGen::linkWithLLD(const llvm::SmallVectorImpl<char>& object,
+                          const std::string& executableFilename) const {
+#if defined(LOOM_HAS_LLD) && defined(__linux__)
+  // Hand the object to LLD through an anonymous in-memory file, so nothing
+  // is written to disk and no process is spawned.
+  int fd = memfd_create("loom-object", MFD_CLOEXEC);
+  if (fd < 0) {
+    LOOM_WARN("[CodeGen] memfd_create failed, using clang driver instead");
+    return linkWithClangDriver(object, executableFilename);
+  }
+  {
+    llvm::raw_fd_ostream memfile(fd, /*shouldClose=*/false);
+    memfile.write(object.data(), object.size());
+    memfile.flush();
+  }
+  std::string objectPath = "/proc/self/fd/" + std::to_string(fd);
+
+  // Same as "clang <obj> -o <exe> -nostdlib -static"
+  std::vector<const char*> args = {"ld.lld",  "-static", "-o",
+                                   executableFilename.c_str(),
+                                   objectPath.c_str()};
+
+  LOOM_DEBUG("[CodeGen] Linking in-process with LLD");
+  lld::Result result = lld::lldMain(args, llvm::outs(), llvm::errs(),
+                                    {{lld::Gnu, &lld::elf::link}});
+  close(fd);
+
+  if (result.retCode != 0) {
+    LOOM_ERROR("[CodeGen] LLD failed with exit code: ", result.retCode);
+    return false;
+  }
+
+  LOOM_DEBUG("[CodeGen] Successfully linked executable: ", executableFilename);
+  return true;
+#else
+  return linkWithClangDriver(object, executableFilename);
+#endif
+}
+
+bool CodeGen::linkWithClangDriver(const llvm::SmallVectorImpl<char>& object,
+                                  const std::string& executableFilename) const {
+  // The clang driver needs the object on disk
+  int fd;
+  llvm::SmallString<128> objectPath;
+  if (std::error_code EC =
+          llvm::sys::fs::createTemporaryFile("loom", "o", fd, objectPath)) {
+    LOOM_ERROR("[CodeGen] Could not create temporary object file: ",
+               EC.message());
+    return false;
+  }
+  {
+    llvm::raw_fd_ostream dest(fd, /*shouldClose=*/true);
+    dest.write(object.data(), object.size());
+  }
+  std::string objectFilename = objectPath.str().str();
+
+  std::string linkCmd = "clang \"" + objectFilename + "\" -o \"" +
+                        executableFilename + "\"" +
+                        clangLinkFlags(detectTargetPlatform());
+
+  LOOM_DEBUG("[CodeGen] Running linker: ", linkCmd);
 
   int result = std::system(linkCmd.c_str());
+  llvm::sys::fs::remove(objectFilename);
   if (result == 0) {
-    std::cout << "[CodeGen] Successfully linked executable: "
-              << executableFilename << std::endl;
+    LOOM_DEBUG("[CodeGen] Successfully linked executable: ",
+               executableFilename);
     return true;
   } else {
-    std::cerr << "[CodeGen] Linking failed with exit code: " << result
-              << std::endl;
+    LOOM_ERROR("[CodeGen] Linking failed with exit code: ", result);
     return false;
   }
 }
 
-// --- Function Declaration Codegen ---
-llvm::Value* CodeGen::codegen(FunctionDeclNode& node) {
-  std::cout << "[CodeGen] Generating function: " << node.name << std::endl;
+bool CodeGen::runJIT(int& exit_code) {
+  LOOM_DEBUG("[CodeGen] Running main with ORC LLJIT");
+
+  llvm::Function* main_function = module->getFunction("main");
+  if (!main_function) {
+    LOOM_ERROR("[CodeGen] Program has no main function to run");
+    return false;
+  }
+
+  auto jtmb = llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!jtmb) {
+    LOOM_ERROR("[CodeGen] Could not detect host target: ",
+               llvm::toString(jtmb.takeError()));
+    return false;
+  }
+  jtmb->setCodeGenOptLevel(toCodeGenOptLevel(opt_level));
+
+  // Optimize with the same pipeline as the object file path, but for the
+  // host the JIT is going to generate code for
+  auto target_machine = jtmb->createTargetMachine();
+  if (!target_machine) {
+    LOOM_ERROR("[CodeGen] Could not create host target machine: ",
+               llvm::toString(target_machine.takeError()));
+    return false;
+  }
+  module->setTargetTriple((*target_machine)->getTargetTriple());
+  module->setDataLayout((*target_machine)->createDataLayout());
+  optimizeModule(**target_machine);
+
+  auto jit = llvm::orc::LLJITBuilder()
+                 .setJITTargetMachineBuilder(std::move(*jtmb))
+                 .create();
+  if (!jit) {
+    LOOM_ERROR("[CodeGen] Could not create LLJIT: ",
+               llvm::toString(jit.takeError()));
+    return false;
+  }
+
+  // Resolve external calls (ExitProcess etc. on Windows) against the host
+  auto process_symbols =
+      llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+          (*jit)->getDataLayout().getGlobalPrefix());
+  if (!process_symbols) {
+    LOOM_ERROR("[CodeGen] Could not load host process symbols: ",
+               llvm::toString(process_symbols.takeError()));
+    return false;
+  }
+  (*jit)->getMainJITDylib().addGenerator(std::move(*process_symbols));
 
+  llvm::Type* main_return_type = main_function->getReturnType();
+  unsigned main_return_bits = main_return_type->isIntegerTy()
+                                  ? main_return_type->getIntegerBitWidth()
+                                  : 0;
+  if (main_return_bits != 8 && main_return_bits != 16 &&
+      main_return_bits != 32 && main_return_bits != 64) {
+    LOOM_ERROR("[CodeGen] main must return i8, i16, i32 or i64 to be run");
+    return false;
+  }
+
+  llvm::orc::ThreadSafeModule thread_safe_module(std::move(module),
+                                                 std::move(context));
+  if (auto err = (*jit)->addIRModule(std::move(thread_safe_module))) {
+    LOOM_ERROR("[CodeGen] Could not add module to JIT: ",
+               llvm::toString(std::move(err)));
+    return false;
+  }
+
+  // Looking main up is what makes ORC compile the module
+  auto jit_main = [&]() {
+    TimeReport::Scope time_scope("JIT compilation");
+    return (*jit)->lookup("main");
+  }();
+  if (!jit_main) {
+    LOOM_ERROR("[CodeGen] Could not find main in JIT: ",
+               llvm::toString(jit_main.takeError()));
+    return false;
+  }
+
+  TimeReport::Scope time_scope("Execution");
+  switch (main_return_bits) {
+    case 8:
+      exit_code = jit_main->toPtr<int8_t (*)()>()();
+      break;
+    case 16:
+      exit_code = jit_main->toPtr<int16_t (*)()>()();
+      break;
+    case 32:
+      exit_code = jit_main->toPtr<int32_t (*)()>()();
+      break;
+    default:
+      exit_code = static_cast<int>(jit_main->toPtr<int64_t (*)()>()());
+      break;
+  }
+
+  LOOM_DEBUG("[CodeGen] main returned ", exit_code);
+  return true;
+}
+
+// --- Function Declaration Codegen ---
+// Creates the prototype of a function. Top-level functions are declared
+// before any body is generated, so calls may precede the definition.
+llvm::Function* CodeGen::declareFunction(FunctionDeclNode& node) {
   // 1. Convert parameter types to LLVM types
   std::vector<llvm::Type*> param_types;
   for (auto& param : node.parameters) {
     llvm::Type* llvm_type = typeToLLVMType(*param->type);
     if (!llvm_type) {
-      std::cout << "[CodeGen] ERROR: Failed to convert parameter type"
-                << std::endl;
+      LOOM_ERROR("[CodeGen] Failed to convert parameter type");
       return nullptr;
     }
     param_types.push_back(llvm_type);
@@ -1333,8 +1646,7 @@ llvm::Value* CodeGen::codegen(FunctionDeclNode& node) {
   if (node.return_type) {
     return_type = typeToLLVMType(*node.return_type);
     if (!return_type) {
-      std::cout << "[CodeGen] ERROR: Failed to convert return type"
-                << std::endl;
+      LOOM_ERROR("[CodeGen] Failed to convert return type");
       return nullptr;
     }
   }
@@ -1345,19 +1657,37 @@ llvm::Value* CodeGen::codegen(FunctionDeclNode& node) {
 
   // 4. Create function
   llvm::Function* llvm_func = llvm::Function::Create(
-      func_type, llvm::Function::ExternalLinkage, node.name, module.get());
+      func_type, llvm::Function::ExternalLinkage, node.name.str(),
+      module.get());
 
   if (!llvm_func) {
-    std::cout << "[CodeGen] ERROR: Failed to create function" << std::endl;
+    LOOM_ERROR("[CodeGen] Failed to create function");
     return nullptr;
   }
 
   // 5. Set parameter names
   auto arg_it = llvm_func->arg_begin();
   for (size_t i = 0; i < node.parameters.size(); ++i, ++arg_it) {
-    arg_it->setName(node.parameters[i]->name);
+    arg_it->setName(node.parameters[i]->name.str());
   }
 
+  return llvm_func;
+}
+
+llvm::Value* CodeGen::codegen(FunctionDeclNode& node) {
+  LOOM_DEBUG("[CodeGen] Generating function: ", node.name);
+  if (node.body_pending) return nullptr;  // unreachable, see generate()
+  llvm::TimeTraceScope time_scope("CodeGen function", node.name.str());
+
+  llvm::Function* llvm_func = module->getFunction(node.name.str());
+  if (!llvm_func) {
+    llvm_func = declareFunction(node);
+    if (!llvm_func) {
+      return nullptr;
+    }
+  }
+  llvm::Type* return_type = llvm_func->getReturnType();
+
   // 6. Create entry block
   llvm::BasicBlock* entry_block =
       llvm::BasicBlock::Create(*context, "entry", llvm_func);
@@ -1365,22 +1695,29 @@ llvm::Value* CodeGen::codegen(FunctionDeclNode& node) {
   // Save current insertion point and function context
   llvm::BasicBlock* prev_block = builder->GetInsertBlock();
   llvm::Function* prev_function = current_function;
+  llvm::Instruction* prev_alloca_insert_point = alloca_insert_point;
 
   // Switch to function context
   builder->SetInsertPoint(entry_block);
   current_function = llvm_func;
 
+  // Placeholder that marks where entry-block allocas go; removed once the
+  // body has been generated.
+  alloca_insert_point = new llvm::BitCastInst(
+      llvm::PoisonValue::get(builder->getInt32Ty()), builder->getInt32Ty(),
+      "allocapt", entry_block);
+
   // Save previous named values (for nested scopes)
   auto prev_named_values = named_values;
   auto prev_variable_types = variable_types;
 
   // 7. Add parameters to symbol table
-  arg_it = llvm_func->arg_begin();
+  auto arg_it = llvm_func->arg_begin();
   for (size_t i = 0; i < node.parameters.size(); ++i, ++arg_it) {
     // Create alloca for parameter (for mutable parameters)
     llvm::Type* param_type = typeToLLVMType(*node.parameters[i]->type);
     llvm::AllocaInst* alloca =
-        builder->CreateAlloca(param_type, nullptr, node.parameters[i]->name);
+        createEntryBlockAlloca(param_type, node.parameters[i]->name.str());
 
     // Store parameter value in alloca
     builder->CreateStore(&*arg_it, alloca);
@@ -1406,9 +1743,7 @@ llvm::Value* CodeGen::codegen(FunctionDeclNode& node) {
   } else {
     // Non-void function - should have return statement
     if (builder->GetInsertBlock()->getTerminator() == nullptr) {
-      std::cout
-          << "[CodeGen] WARNING: Non-void function without return statement"
-          << std::endl;
+      LOOM_WARN("[CodeGen] Non-void function without return statement");
       // Add default return (could be improved)
       if (return_type->isIntegerTy()) {
         builder->CreateRet(llvm::ConstantInt::get(return_type, 0));
@@ -1419,6 +1754,8 @@ llvm::Value* CodeGen::codegen(FunctionDeclNode& node) {
   }
 
   // 10. Restore previous context
+  alloca_insert_point->eraseFromParent();
+  alloca_insert_point = prev_alloca_insert_point;
   current_function = prev_function;
   named_values = prev_named_values;
   variable_types = prev_variable_types;
@@ -1427,18 +1764,16 @@ llvm::Value* CodeGen::codegen(FunctionDeclNode& node) {
     builder->SetInsertPoint(prev_block);
   }
 
-  std::cout << "[CodeGen] Function generation complete: " << node.name
-            << std::endl;
+  LOOM_DEBUG("[CodeGen] Function generation complete: ", node.name);
   return llvm_func;
 }
 
 // --- Return Statement Codegen ---
 llvm::Value* CodeGen::codegen(ReturnStmtNode& node) {
-  std::cout << "[CodeGen] Generating return statement" << std::endl;
+  LOOM_DEBUG("[CodeGen] Generating return statement");
 
   if (!current_function) {
-    std::cout << "[CodeGen] ERROR: Return statement outside function"
-              << std::endl;
+    LOOM_ERROR("[CodeGen] Return statement outside function");
     return nullptr;
   }
 
@@ -1446,8 +1781,7 @@ llvm::Value* CodeGen::codegen(ReturnStmtNode& node) {
     // Return with value
     llvm::Value* return_value = codegen(*node.expression);
     if (!return_value) {
-      std::cout << "[CodeGen] ERROR: Failed to generate return expression"
-                << std::endl;
+      LOOM_ERROR("[CodeGen] Failed to generate return expression");
       return nullptr;
     }
 
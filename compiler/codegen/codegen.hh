@@ -4,9 +4,14 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>  // Hinzufügen
 
+#include "../common/symbol.hh"
+
 // LLVM-Header
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
@@ -23,6 +28,9 @@
 // Platform detection and syscall support
 enum class TargetPlatform { Windows, Linux, MacOS, Unknown };
 
+// Optimization levels selectable from the driver (-O0 ... -O3, -Os)
+enum class OptLevel { O0, O1, O2, O3, Os };
+
 // Forward-Deklarationen
 class StmtNode;  // Wir arbeiten mit der Basisklasse für Statements
 class ASTNode;
@@ -47,20 +55,47 @@ class Identifier;
 class CodeGen {
  public:
   CodeGen();
+  ~CodeGen();
 
   // NEU: Akzeptiert einen Vektor von Statements
-  void generate(const std::vector<std::unique_ptr<StmtNode>>& ast);
+  void generate(const std::vector<StmtNode*>& ast);
 
   void print_ir() const;
   // Write IR to file
   void writeIRToFile(const std::string& filename) const;
 
   // Integrated compilation methods (like Kaleidoscope)
-  bool compileToObjectFile(const std::string& filename) const;
-  bool compileToExecutable(const std::string& objectFilename,
+  // Emits the object file into memory; it never touches the disk.
+  bool compileToObjectFile(llvm::SmallVectorImpl<char>& object) const;
+  // Links an in-memory object. On Linux this runs LLD in-process when the
+  // compiler was built with it (LOOM_HAS_LLD), otherwise the clang driver.
+  bool compileToExecutable(const llvm::SmallVectorImpl<char>& object,
                            const std::string& executableFilename) const;
-  // Initialize LLVM targets (call once at startup)
+  // Initialize LLVM targets (only the first call does any work)
   bool initializeLLVMTargets();
+  // Builds the TargetMachine for this CodeGen's target and -O level ahead of
+  // time, so a long-running compile server doesn't pay for it per request
+  bool preloadTargetMachine() const;
+
+  // JIT mode: generate() emits no _start/mainCRTStartup entry point, main's
+  // result is returned to the caller of runJIT instead of an exit syscall.
+  // Must be set before generate().
+  void setJITMode(bool enabled) { jit_mode = enabled; }
+  // Executes main in-process through ORC LLJIT and stores its result in
+  // exit_code. Takes ownership of the module and context; the CodeGen cannot
+  // emit anything afterwards.
+  bool runJIT(int& exit_code);
+
+  // Optimization level used by compileToObjectFile (default: -O0)
+  void setOptimizationLevel(OptLevel level) { opt_level = level; }
+  OptLevel getOptimizationLevel() const { return opt_level; }
+
+  // Target triple, CPU, features and optimization level of the object this
+  // CodeGen emits. Part of the compilation cache key.
+  std::string getTargetDescription() const;
+  // Linker and flags compileToExecutable uses. Part of the compilation
+  // cache key, since cached executables depend on it.
+  std::string getLinkerDescription() const;
 
   // Public access to LLVM module for external compilation
   std::unique_ptr<llvm::Module> module;
@@ -68,10 +103,15 @@ class CodeGen {
  private:
   std::unique_ptr<llvm::LLVMContext> context;
   std::unique_ptr<llvm::IRBuilder<>> builder;
-  std::map<std::string, llvm::Value*> named_values;
-  std::map<std::string, llvm::Type*>
+  std::unordered_map<Symbol, llvm::Value*> named_values;
+  std::unordered_map<Symbol, llvm::Type*>
       variable_types;                // Track types for opaque pointers
   llvm::Function* current_function;  // For return statement handling
+  // Marker in current_function's entry block; all local and parameter
+  // allocas are placed before it so mem2reg can always promote them.
+  llvm::Instruction* alloca_insert_point;
+  OptLevel opt_level = OptLevel::O0;
+  bool jit_mode = false;
   // Dispatch-Methoden (unverändert)
   llvm::Value* codegen(ASTNode& node);
   llvm::Value* codegen(NumberLiteral& node);
@@ -84,23 +124,42 @@ class CodeGen {
   llvm::Value* codegen(FunctionCallExpr& node);
   llvm::Value* codegen(BuiltinCallExpr& node);
   llvm::Value* codegen(FunctionDeclNode& node);
+  llvm::Function* declareFunction(FunctionDeclNode& node);
   llvm::Value* codegen(ReturnStmtNode& node);
   llvm::Value* codegen(BinaryExpr& node);
   llvm::Value* codegen(Identifier& node);
   llvm::Type* typeToLLVMType(TypeNode& type);
 
+  // Create a stack slot in the entry block of the current function
+  llvm::AllocaInst* createEntryBlockAlloca(llvm::Type* type,
+                                           const std::string& name);
+
   // Generate code for a node with a specific target type (for type casting)
   llvm::Value* codegenWithTargetType(ASTNode& node, llvm::Type* targetType);
 
   // Generate Windows entry point for freestanding executables
   void generateEntryPoint();
 
+  // Target selection and the new-PassManager optimization pipeline
+  std::string getTargetTripleString() const;
+  std::unique_ptr<llvm::TargetMachine> createTargetMachine(
+      const std::string& target_triple) const;
+  // Process-wide cache in front of createTargetMachine
+  llvm::TargetMachine* getTargetMachine(const std::string& target_triple) const;
+  void optimizeModule(llvm::TargetMachine& target_machine) const;
+
+  // Linker backends used by compileToExecutable
+  bool linkWithLLD(const llvm::SmallVectorImpl<char>& object,
+                   const std::string& executableFilename) const;
+  bool linkWithClangDriver(const llvm::SmallVectorImpl<char>& object,
+                           const std::string& executableFilename) const;
+
   // Cross-platform syscall support
   TargetPlatform detectTargetPlatform() const;
-  llvm::Value* generateLinuxSyscall(const std::string& name,
+  llvm::Value* generateLinuxSyscall(std::string_view name,
                                     std::vector<llvm::Value*>& args);
-  llvm::Value* generateMacOSSyscall(const std::string& name,
+  llvm::Value* generateMacOSSyscall(std::string_view name,
                                     std::vector<llvm::Value*>& args);
-  llvm::Value* generateWindowsSyscall(const std::string& name,
+  llvm::Value* generateWindowsSyscall(std::string_view name,
                                       std::vector<llvm::Value*>& args);
 };
\ No newline at end of file
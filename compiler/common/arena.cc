@@ -0,0 +1,38 @@
+// compiler/common/arena.cc
+#include "arena.hh"
+
+#include <algorithm>
+#include <cstdint>
+
+static char* alignUp(char* p, size_t alignment) {
+  uintptr_t value = reinterpret_cast<uintptr_t>(p);
+  return reinterpret_cast<char*>((value + alignment - 1) & ~(alignment - 1));
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+  bytes_allocated += size;
+  if (cursor) {
+    char* result = alignUp(cursor, alignment);
+    if (size <= static_cast<size_t>(end - result)) {
+      cursor = result + size;
+      return result;
+    }
+  }
+
+  // Requests that don't fit a fresh slab get one of their own, so the
+  // current slab keeps serving small nodes
+  if (size + alignment > next_slab_size) {
+    // new[] rather than make_unique: the memory needn't be zeroed
+    slabs.emplace_back(new char[size + alignment]);
+    return alignUp(slabs.back().get(), alignment);
+  }
+
+  slabs.emplace_back(new char[next_slab_size]);
+  cursor = slabs.back().get();
+  end = cursor + next_slab_size;
+  next_slab_size = std::min(next_slab_size * 2, kMaxSlabSize);
+
+  char* result = alignUp(cursor, alignment);
+  cursor = result + size;
+  return result;
+}
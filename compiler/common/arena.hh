@@ -0,0 +1,60 @@
+// compiler/common/arena.hh
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump-pointer allocator for objects that all die together, like the nodes
+// of an AST. An allocation just advances a pointer in the current slab.
+// Nothing is freed on its own and no destructor ever runs, so only
+// trivially destructible types can be created; dropping the arena releases
+// all slabs at once. Not thread-safe: give every thread its own arena.
+class Arena {
+ public:
+  Arena() = default;
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // alignment must be a power of two
+  void* allocate(size_t size, size_t alignment);
+
+  template <typename T, typename... Args>
+  T* create(Args&&... args) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "arena objects are never destroyed");
+    return new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  // Moves a list built up in a temporary vector into the arena
+  template <typename T>
+  std::span<T> copy(const std::vector<T>& items) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (items.empty()) return {};
+    T* data = static_cast<T*>(allocate(sizeof(T) * items.size(), alignof(T)));
+    std::memcpy(data, items.data(), sizeof(T) * items.size());
+    return {data, items.size()};
+  }
+
+  // Bytes handed out so far, not counting slab slack
+  size_t getBytesAllocated() const { return bytes_allocated; }
+
+ private:
+  // Slabs start small so tiny programs stay cheap and double up to the
+  // maximum, like LLVM's BumpPtrAllocator
+  static constexpr size_t kInitialSlabSize = size_t{4} << 10;
+  static constexpr size_t kMaxSlabSize = size_t{1} << 20;
+
+  std::vector<std::unique_ptr<char[]>> slabs;
+  char* cursor = nullptr;
+  char* end = nullptr;
+  size_t next_slab_size = kInitialSlabSize;
+  size_t bytes_allocated = 0;
+};
@@ -1,3 +1,3 @@
 #include "logger.hh"
 
-LogLevel Logger::current_level = LogLevel::INFO;
+LogLevel Logger::current_level = LogLevel::WARN;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <sstream>
 #include <string>
 
 enum class LogLevel { ERROR = 0, WARN = 1, INFO = 2, DEBUG = 3 };
@@ -11,28 +12,73 @@ class Logger {
 
  public:
   static void setLevel(LogLevel level) { current_level = level; }
+  static LogLevel getLevel() { return current_level; }
+
+  // With LOOM_STRIP_DEBUG_LOGGING, DEBUG is disabled at compile time so
+  // the optimizer can drop debug output entirely.
+  static bool isEnabled(LogLevel level) {
+#ifdef LOOM_STRIP_DEBUG_LOGGING
+    if (level == LogLevel::DEBUG) {
+      return false;
+    }
+#endif
+    return current_level >= level;
+  }
+
+  // Concatenates any streamable parts into one message.
+  template <typename... Args>
+  static std::string format(const Args&... args) {
+    std::ostringstream stream;
+    (stream << ... << args);
+    return stream.str();
+  }
 
   static void error(const std::string& message) {
-    if (current_level >= LogLevel::ERROR) {
+    if (isEnabled(LogLevel::ERROR)) {
       std::cerr << "Error: " << message << std::endl;
     }
   }
 
   static void warn(const std::string& message) {
-    if (current_level >= LogLevel::WARN) {
+    if (isEnabled(LogLevel::WARN)) {
       std::cerr << "Warning: " << message << std::endl;
     }
   }
 
   static void info(const std::string& message) {
-    if (current_level >= LogLevel::INFO) {
+    if (isEnabled(LogLevel::INFO)) {
       std::cout << message << std::endl;
     }
   }
 
   static void debug(const std::string& message) {
-    if (current_level >= LogLevel::DEBUG) {
+    if (isEnabled(LogLevel::DEBUG)) {
       std::cout << "[DEBUG] " << message << std::endl;
     }
   }
 };
+
+// The macros check the level before formatting the message; when the
+// level is disabled the arguments are not evaluated.
+#define LOOM_LOG_AT(level, method, ...)            \
+  do {                                             \
+    if (Logger::isEnabled(level)) {                \
+      Logger::method(Logger::format(__VA_ARGS__)); \
+    }                                              \
+  } while (0)
+
+#define LOOM_ERROR(...) LOOM_LOG_AT(LogLevel::ERROR, error, __VA_ARGS__)
+#define LOOM_WARN(...) LOOM_LOG_AT(LogLevel::WARN, warn, __VA_ARGS__)
+#define LOOM_INFO(...) LOOM_LOG_AT(LogLevel::INFO, info, __VA_ARGS__)
+
+#ifdef LOOM_STRIP_DEBUG_LOGGING
+// Arguments are still type-checked but generate no code
+#define LOOM_DEBUG(...)            \
+  do {                             \
+    if (false) {                   \
+      Logger::format(__VA_ARGS__); \
+    }                              \
+  } while (0)
+#else
+#define LOOM_DEBUG(...) LOOM_LOG_AT(LogLevel::DEBUG, debug, __VA_ARGS__)
+#endif
@@ -0,0 +1,62 @@
+// compiler/common/symbol.cc
+#include "symbol.hh"
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+// The interner is split into shards with their own lock, so files that are
+// scanned in parallel rarely wait for each other. An id holds the shard in
+// its low bits and the 1-based index within the shard above them; 0 is the
+// empty name.
+static constexpr uint32_t kShardBits = 4;
+static constexpr uint32_t kShardCount = 1u << kShardBits;
+
+struct InternerShard {
+  std::shared_mutex mutex;
+  // Names never move once added, so the index can key on views of them
+  std::deque<std::string> names;
+  std::unordered_map<std::string_view, uint32_t> index;
+};
+
+// Function-local so that symbols can be interned during static
+// initialization of other translation units
+static std::array<InternerShard, kShardCount>& shards() {
+  static std::array<InternerShard, kShardCount> instance;
+  return instance;
+}
+
+Symbol Symbol::intern(std::string_view name) {
+  if (name.empty()) return Symbol();
+
+  uint32_t shard_index =
+      std::hash<std::string_view>{}(name) & (kShardCount - 1);
+  InternerShard& shard = shards()[shard_index];
+
+  {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.index.find(name);
+    if (it != shard.index.end()) return Symbol(it->second);
+  }
+
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  auto it = shard.index.find(name);
+  if (it != shard.index.end()) return Symbol(it->second);
+
+  shard.names.emplace_back(name);
+  uint32_t id =
+      (static_cast<uint32_t>(shard.names.size()) << kShardBits) | shard_index;
+  shard.index.emplace(shard.names.back(), id);
+  return Symbol(id);
+}
+
+const std::string& Symbol::str() const {
+  static const std::string empty_name;
+  if (value == 0) return empty_name;
+
+  InternerShard& shard = shards()[value & (kShardCount - 1)];
+  std::shared_lock<std::shared_mutex> lock(shard.mutex);
+  return shard.names[(value >> kShardBits) - 1];
+}
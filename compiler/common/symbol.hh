@@ -0,0 +1,42 @@
+// compiler/common/symbol.hh
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// An interned name. Every distinct spelling gets one 32-bit id for the
+// lifetime of the process, so phases can key their tables on ids and
+// compare names with a single integer compare. Interning is thread-safe;
+// the default Symbol is the empty name.
+class Symbol {
+ public:
+  Symbol() = default;
+
+  static Symbol intern(std::string_view name);
+
+  // The spelling; the reference stays valid for the rest of the process
+  const std::string& str() const;
+
+  uint32_t id() const { return value; }
+  bool empty() const { return value == 0; }
+
+  bool operator==(Symbol other) const { return value == other.value; }
+  bool operator!=(Symbol other) const { return value != other.value; }
+
+ private:
+  explicit Symbol(uint32_t value) : value(value) {}
+
+  uint32_t value = 0;
+};
+
+inline std::ostream& operator<<(std::ostream& os, Symbol symbol) {
+  return os << symbol.str();
+}
+
+template <>
+struct std::hash<Symbol> {
+  size_t operator()(Symbol symbol) const noexcept { return symbol.id(); }
+};
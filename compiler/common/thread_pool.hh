@@ -0,0 +1,50 @@
+// compiler/common/thread_pool.hh
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size pool of worker threads used to run independent frontend jobs
+// (e.g. scanning and parsing separate files) concurrently.
+class ThreadPool {
+ public:
+  // thread_count == 0 picks std::thread::hardware_concurrency()
+  explicit ThreadPool(unsigned thread_count = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Queues a task; the future yields its result (or rethrows its exception)
+  template <typename Func>
+  std::future<std::invoke_result_t<Func>> submit(Func&& task) {
+    using Result = std::invoke_result_t<Func>;
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(
+        std::forward<Func>(task));
+    std::future<Result> result = packaged->get_future();
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      tasks.emplace([packaged]() { (*packaged)(); });
+    }
+    queue_cv.notify_one();
+    return result;
+  }
+
+  unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+ private:
+  void workerLoop();
+
+  std::vector<std::thread> workers;
+  std::queue<std::function<void()>> tasks;
+  std::mutex queue_mutex;
+  std::condition_variable queue_cv;
+  bool stopping = false;
+};
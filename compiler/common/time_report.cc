@@ -0,0 +1,241 @@
+#include "time_report.hh"
+
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+
+#include "logger.hh"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/TimeProfiler.h"
+
+#ifdef _WIN32
+#include <windows.h>
+// windows.h must come first
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+bool TimeReport::enabled = false;
+std::mutex TimeReport::mutex;
+std::vector<PhaseTiming> TimeReport::phases;
+std::string TimeReport::llvm_pass_report;
+bool TimeReport::tracing = false;
+unsigned TimeReport::trace_granularity_us = 0;
+
+void TimeReport::record(const std::string& name, double wall_seconds,
+                        double cpu_seconds, int64_t peak_rss_delta_kb) {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto& phase : phases) {
+    if (phase.name == name) {
+      phase.wall_seconds += wall_seconds;
+      phase.cpu_seconds += cpu_seconds;
+      phase.peak_rss_delta_kb += peak_rss_delta_kb;
+      phase.count++;
+      return;
+    }
+  }
+  phases.push_back({name, wall_seconds, cpu_seconds, peak_rss_delta_kb, 1});
+}
+
+void TimeReport::addLLVMPassReport(const std::string& report) {
+  std::lock_guard<std::mutex> lock(mutex);
+  llvm_pass_report += report;
+}
+
+void TimeReport::printTable(std::ostream& out) {
+  std::lock_guard<std::mutex> lock(mutex);
+  out << "===-------------------------------------------------------------==="
+      << std::endl
+      << "                       Loom compilation time report" << std::endl
+      << "===-------------------------------------------------------------==="
+      << std::endl;
+  out << std::left << std::setw(28) << "Phase" << std::right << std::setw(12)
+      << "Wall (ms)" << std::setw(12) << "CPU (ms)" << std::setw(16)
+      << "Peak RSS +KiB" << std::endl;
+  out << std::fixed << std::setprecision(3);
+  for (const auto& phase : phases) {
+    std::string name = phase.name;
+    if (phase.count > 1) {
+      name += " (x" + std::to_string(phase.count) + ")";
+    }
+    out << std::left << std::setw(28) << name << std::right << std::setw(12)
+        << phase.wall_seconds * 1000.0 << std::setw(12)
+        << phase.cpu_seconds * 1000.0 << std::setw(16)
+        << phase.peak_rss_delta_kb << std::endl;
+  }
+  out << std::defaultfloat;
+  if (!llvm_pass_report.empty()) {
+    out << std::endl << llvm_pass_report;
+  }
+}
+
+static std::string escapeJSON(const std::string& text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (char c : text) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buffer[8];
+          std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+          escaped += buffer;
+        } else {
+          escaped += c;
+        }
+    }
+  }
+  return escaped;
+}
+
+void TimeReport::printJSON(std::ostream& out) {
+  std::lock_guard<std::mutex> lock(mutex);
+  out << "{\"phases\": [";
+  for (size_t i = 0; i < phases.size(); ++i) {
+    const auto& phase = phases[i];
+    out << (i ? ", " : "") << "{\"name\": \"" << escapeJSON(phase.name)
+        << "\", \"wall_ms\": " << phase.wall_seconds * 1000.0
+        << ", \"cpu_ms\": " << phase.cpu_seconds * 1000.0
+        << ", \"peak_rss_delta_kb\": " << phase.peak_rss_delta_kb
+        << ", \"count\": " << phase.count << "}";
+  }
+  out << "], \"llvm_pass_report\": \"" << escapeJSON(llvm_pass_report)
+      << "\"}" << std::endl;
+}
+
+double TimeReport::threadCPUSeconds() {
+#ifdef _WIN32
+  FILETIME creation, exit, kernel, user;
+  if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+    return 0;
+  }
+  auto to100ns = [](const FILETIME& time) {
+    return (static_cast<uint64_t>(time.dwHighDateTime) << 32) |
+           time.dwLowDateTime;
+  };
+  return static_cast<double>(to100ns(kernel) + to100ns(user)) / 1e7;
+#else
+  timespec now;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) {
+    return 0;
+  }
+  return static_cast<double>(now.tv_sec) +
+         static_cast<double>(now.tv_nsec) / 1e9;
+#endif
+}
+
+int64_t TimeReport::peakRSSKilobytes() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                            sizeof(counters))) {
+    return 0;
+  }
+  return static_cast<int64_t>(counters.PeakWorkingSetSize / 1024);
+#else
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return static_cast<int64_t>(usage.ru_maxrss / 1024);  // bytes on macOS
+#else
+  return static_cast<int64_t>(usage.ru_maxrss);  // KiB on Linux
+#endif
+#endif
+}
+
+void TimeReport::startTimeTrace(unsigned granularity_us) {
+  trace_granularity_us = granularity_us;
+  llvm::timeTraceProfilerInitialize(granularity_us, "loom");
+  tracing = true;
+}
+
+bool TimeReport::finishTimeTrace(const std::string& path) {
+  if (!tracing) return true;
+  tracing = false;
+
+  bool written = true;
+  if (llvm::Error error = llvm::timeTraceProfilerWrite(path, "loom")) {
+    std::string message = llvm::toString(std::move(error));
+    LOOM_ERROR("Could not write time trace: ", message);
+    written = false;
+  }
+  llvm::timeTraceProfilerCleanup();
+  return written;
+}
+
+TimeReport::ThreadTrace::ThreadTrace() : active(TimeReport::isTracing()) {
+  // The calling thread may already be profiled (e.g. a job run inline on
+  // the main thread)
+  if (active && !llvm::timeTraceProfilerEnabled()) {
+    llvm::timeTraceProfilerInitialize(trace_granularity_us, "loom");
+  } else {
+    active = false;
+  }
+}
+
+TimeReport::ThreadTrace::~ThreadTrace() {
+  if (active) {
+    // Hands this thread's events over to be merged into the trace
+    llvm::timeTraceProfilerFinishThread();
+  }
+}
+
+// Scopes measuring on this thread form a stack through Scope::enclosing
+static thread_local TimeReport::Scope* current_scope = nullptr;
+
+TimeReport::Scope::Scope(const char* name)
+    : name(name),
+      active(TimeReport::isEnabled()),
+      traced(llvm::timeTraceProfilerEnabled()) {
+  if (traced) {
+    llvm::timeTraceProfilerBegin(name, "");
+  }
+  if (!active) return;
+  enclosing = current_scope;
+  current_scope = this;
+  peak_rss_start_kb = peakRSSKilobytes();
+  cpu_start = threadCPUSeconds();
+  wall_start = std::chrono::steady_clock::now();
+}
+
+TimeReport::Scope::~Scope() {
+  if (traced) {
+    llvm::timeTraceProfilerEnd();
+  }
+  if (!active) return;
+  current_scope = enclosing;
+  std::chrono::duration<double> wall =
+      std::chrono::steady_clock::now() - wall_start;
+  double cpu = threadCPUSeconds() - cpu_start + worker_cpu_seconds.load();
+  record(name, wall.count(), cpu, peakRSSKilobytes() - peak_rss_start_kb);
+}
+
+TimeReport::Scope* TimeReport::Scope::current() { return current_scope; }
+
+TimeReport::WorkerCPU::WorkerCPU(Scope* phase) : phase(phase) {
+  if (phase) {
+    cpu_start = threadCPUSeconds();
+  }
+}
+
+TimeReport::WorkerCPU::~WorkerCPU() {
+  if (!phase) return;
+  const double cpu = threadCPUSeconds() - cpu_start;
+  for (Scope* scope = phase; scope; scope = scope->enclosing) {
+    scope->worker_cpu_seconds.fetch_add(cpu);
+  }
+}
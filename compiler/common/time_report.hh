@@ -0,0 +1,119 @@
+// compiler/common/time_report.hh
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Per-phase measurements collected for --time-report, and the phase scopes
+// of the --time-trace Chrome trace (built on llvm::timeTraceProfiler). Like
+// Logger this is process-wide static state, so every phase can record
+// itself without threading a context object through the pipeline.
+struct PhaseTiming {
+  std::string name;
+  double wall_seconds = 0;
+  double cpu_seconds = 0;        // CPU time of the thread(s) running it
+  int64_t peak_rss_delta_kb = 0;  // growth of the process' peak RSS
+  unsigned count = 0;            // scopes merged into this entry
+};
+
+class TimeReport {
+ private:
+  static bool enabled;
+  static std::mutex mutex;
+  static std::vector<PhaseTiming> phases;
+  static std::string llvm_pass_report;
+  static bool tracing;
+  static unsigned trace_granularity_us;
+
+ public:
+  static void setEnabled(bool value) { enabled = value; }
+  static bool isEnabled() { return enabled; }
+
+  // Adds one measurement; repeated names (e.g. the same phase for several
+  // files) are summed. Safe to call from worker threads.
+  static void record(const std::string& name, double wall_seconds,
+                     double cpu_seconds, int64_t peak_rss_delta_kb);
+  // Output of LLVM's TimePassesHandler for the optimization pipeline
+  static void addLLVMPassReport(const std::string& report);
+
+  static void printTable(std::ostream& out);
+  static void printJSON(std::ostream& out);
+
+  // --time-trace: starts llvm::timeTraceProfiler on the calling thread;
+  // events shorter than granularity_us are dropped
+  static void startTimeTrace(unsigned granularity_us = 0);
+  static bool isTracing() { return tracing; }
+  // Writes the Chrome trace-event JSON and stops profiling
+  static bool finishTimeTrace(const std::string& path);
+
+  // Worker threads must hold one of these around their jobs so their events
+  // are collected into the trace. No-op unless tracing.
+  class ThreadTrace {
+   public:
+    ThreadTrace();
+    ~ThreadTrace();
+
+    ThreadTrace(const ThreadTrace&) = delete;
+    ThreadTrace& operator=(const ThreadTrace&) = delete;
+
+   private:
+    bool active;
+  };
+
+  class WorkerCPU;
+
+  // Measures the enclosing block as one phase, and emits it as a trace
+  // event. Costs nothing beyond two flag checks when both are disabled.
+  // CPU time is that of the thread the scope is on, plus whatever jobs it
+  // hands to other threads report through WorkerCPU.
+  class Scope {
+   public:
+    explicit Scope(const char* name);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    // Innermost measuring scope on the calling thread, or null
+    static Scope* current();
+
+   private:
+    friend class WorkerCPU;
+
+    const char* name;
+    bool active;
+    bool traced;
+    Scope* enclosing = nullptr;  // next outer measuring scope on the thread
+    std::chrono::steady_clock::time_point wall_start;
+    double cpu_start = 0;
+    std::atomic<double> worker_cpu_seconds{0};
+    int64_t peak_rss_start_kb = 0;
+  };
+
+  // Held by a job that a phase runs on a worker thread (e.g. a chunk of
+  // scanParallel); adds the job's CPU time to phase, which is
+  // Scope::current() of the thread that submitted the job, and to the
+  // scopes enclosing it. The phase must outlive the job. No-op if null.
+  class WorkerCPU {
+   public:
+    explicit WorkerCPU(Scope* phase);
+    ~WorkerCPU();
+
+    WorkerCPU(const WorkerCPU&) = delete;
+    WorkerCPU& operator=(const WorkerCPU&) = delete;
+
+   private:
+    Scope* phase;
+    double cpu_start = 0;
+  };
+
+  // CPU time consumed by the calling thread, in seconds
+  static double threadCPUSeconds();
+  // Peak resident set size of the process so far, in KiB
+  static int64_t peakRSSKilobytes();
+};
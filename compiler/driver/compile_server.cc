@@ -0,0 +1,167 @@
+#include "compile_server.hh"
+
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+#include "../cache/compile_cache.hh"
+#include "../codegen/codegen.hh"
+#include "../common/logger.hh"
+#include "driver.hh"
+#include "server_protocol.hh"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void requestStop(int) { stop_requested = 1; }
+
+// Runs in the forked child: adopt the client's environment, compile,
+// report the exit code and exit without returning to the accept loop.
+[[noreturn]] static void serveRequest(int connection_fd) {
+  CompileRequest request;
+  if (!receiveRequest(connection_fd, request)) {
+    LOOM_ERROR("[Server] Malformed request");
+    _exit(1);
+  }
+
+  int exit_code = 1;
+  if (chdir(request.working_directory.c_str()) == 0) {
+    for (int i = 0; i < 3; ++i) {
+      dup2(request.fds[i], i);
+      close(request.fds[i]);
+    }
+    // Each request starts from the quiet default, not the server's level
+    Logger::setLevel(LogLevel::WARN);
+    try {
+      exit_code = runDriver(request.args);
+    } catch (const std::exception& e) {
+      LOOM_ERROR(e.what());
+      exit_code = 1;
+    }
+  } else {
+    dprintf(request.fds[2], "Error: Could not enter '%s': %s\n",
+            request.working_directory.c_str(), std::strerror(errno));
+  }
+
+  std::cout.flush();
+  std::cerr.flush();
+  sendExitCode(connection_fd, exit_code);
+  _exit(0);
+}
+
+int runCompileServer(const std::string& socket_path) {
+  // The server reports its own state; requests reset this in the child
+  Logger::setLevel(LogLevel::INFO);
+
+  // Everything done here is inherited by every request
+  for (OptLevel level : {OptLevel::O0, OptLevel::O1, OptLevel::O2,
+                         OptLevel::O3, OptLevel::Os}) {
+    CodeGen code_generator;
+    code_generator.setOptimizationLevel(level);
+    code_generator.initializeLLVMTargets();
+    code_generator.preloadTargetMachine();
+  }
+  // Requests must hit the cache entries of this binary even if it is
+  // replaced on disk while the server runs
+  CompileCache::buildIdentity();
+
+  sockaddr_un address{};
+  if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) {
+    LOOM_ERROR("Invalid server socket path '", socket_path, "'");
+    return 1;
+  }
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+  // A socket file nobody answers on is left over from a crashed server
+  int probe_fd = connectToServer(socket_path);
+  if (probe_fd >= 0) {
+    close(probe_fd);
+    LOOM_ERROR("A server is already listening on ", socket_path);
+    return 1;
+  }
+  unlink(socket_path.c_str());
+
+  // Requests run with the server's privileges; only its user may connect.
+  // The socket file is created owner-only by bind, so there is no window in
+  // which someone else can connect before a chmod.
+  mode_t old_umask = umask(S_IRWXG | S_IRWXO);
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  bool listening = listen_fd >= 0 &&
+                   bind(listen_fd, reinterpret_cast<sockaddr*>(&address),
+                        sizeof(address)) == 0 &&
+                   listen(listen_fd, SOMAXCONN) == 0;
+  umask(old_umask);  // can't fail, so errno still tells why we're not
+  if (!listening) {
+    LOOM_ERROR("Could not listen on ", socket_path, ": ", std::strerror(errno));
+    return 1;
+  }
+
+  // No SA_RESTART, so a stop signal interrupts accept()
+  struct sigaction stop_action {};
+  stop_action.sa_handler = requestStop;
+  sigaction(SIGINT, &stop_action, nullptr);
+  sigaction(SIGTERM, &stop_action, nullptr);
+  // Finished children are reaped automatically
+  signal(SIGCHLD, SIG_IGN);
+  signal(SIGPIPE, SIG_IGN);
+
+  LOOM_INFO("[Server] Listening on ", socket_path);
+
+  while (!stop_requested) {
+    int connection_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (connection_fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      LOOM_ERROR("[Server] accept failed: ", std::strerror(errno));
+      break;
+    }
+    // The file mode keeps others out unless the socket is reached some
+    // other way (e.g. a shared directory with a permissive ACL)
+    if (!peerIsCurrentUser(connection_fd)) {
+      LOOM_WARN("[Server] Rejected a connection from another user");
+      close(connection_fd);
+      continue;
+    }
+
+    // Don't let buffered server output be duplicated into the child
+    std::cout.flush();
+    std::cerr.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(listen_fd);
+      signal(SIGINT, SIG_DFL);
+      signal(SIGTERM, SIG_DFL);
+      // The linker is run through std::system, which needs to wait for it
+      signal(SIGCHLD, SIG_DFL);
+      signal(SIGPIPE, SIG_DFL);
+      serveRequest(connection_fd);
+    }
+    if (pid < 0) {
+      LOOM_ERROR("[Server] fork failed: ", std::strerror(errno));
+    }
+    close(connection_fd);
+  }
+
+  close(listen_fd);
+  unlink(socket_path.c_str());
+  LOOM_INFO("[Server] Stopped");
+  return 0;
+}
+
+#else  // _WIN32
+
+int runCompileServer(const std::string&) {
+  LOOM_ERROR("--server is not supported on Windows yet");
+  return 1;
+}
+
+#endif
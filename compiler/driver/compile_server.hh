@@ -0,0 +1,11 @@
+// compiler/driver/compile_server.hh
+#pragma once
+
+#include <string>
+
+// "loom --server": keeps initialized LLVM targets and TargetMachines
+// resident and serves compile requests from loom-client over a Unix socket.
+// Each request runs in a forked child that inherits that state, works in
+// the client's directory and writes to the client's stdio. Returns when
+// the server is interrupted (SIGINT/SIGTERM).
+int runCompileServer(const std::string& socket_path);
@@ -0,0 +1,402 @@
+// compiler/driver/driver.cc
+#include "driver.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../cache/compile_cache.hh"
+#include "../codegen/codegen.hh"
+#include "../common/arena.hh"
+#include "../common/logger.hh"
+#include "../common/thread_pool.hh"
+#include "../common/time_report.hh"
+#include "../parser/ast_printer.hh"
+#include "../parser/parser_internal.hh"
+#include "../parser/reachability.hh"
+#include "../scanner/scanner_internal.hh"
+#include "../scanner/source_manager.hh"
+#include "../scanner/token_stream.hh"
+#include "../sema/semantic_analyzer.hh"
+#include "llvm/Support/TimeProfiler.h"
+
+// Parses -O0, -O1, -O2, -O3 and -Os. Returns false for unknown levels.
+static bool parseOptLevel(const std::string& arg, OptLevel& level) {
+  if (arg == "-O0") {
+    level = OptLevel::O0;
+  } else if (arg == "-O1") {
+    level = OptLevel::O1;
+  } else if (arg == "-O2") {
+    level = OptLevel::O2;
+  } else if (arg == "-O3") {
+    level = OptLevel::O3;
+  } else if (arg == "-Os") {
+    level = OptLevel::Os;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// One source file and everything the frontend produced for it. The file
+// itself is owned by the SourceManager.
+struct TranslationUnit {
+  const LoomSourceFile* file = nullptr;
+  // Owns the unit's AST nodes. Each unit is parsed on its own thread, so
+  // each gets its own arena.
+  Arena arena;
+  // Files parsed by parseParallel use one arena per range instead
+  std::vector<std::unique_ptr<Arena>> range_arenas;
+  std::vector<StmtNode*> ast;
+  bool had_error = false;
+  bool lazy_bodies = false;  // parsed with Parser::setLazyFunctionBodies
+  // Debug output of scanner/parser and parse errors, printed in file order
+  // after all units finished
+  std::ostringstream log;
+  std::ostringstream diagnostics;
+};
+
+// Scans and parses a single unit. Runs on a worker thread, so it only
+// touches its own unit.
+static void runFrontend(TranslationUnit& unit) {
+  std::string_view filename = unit.file->getFilename();
+  std::string_view source = unit.file->getText();
+  llvm::TimeTraceScope file_trace("Frontend", filename);
+  // Dumping the source and every token is only worth it when debugging
+  const bool debug = Logger::isEnabled(LogLevel::DEBUG);
+  std::ostream& log = unit.log;
+  if (debug) {
+    log << "Compiling file: " << filename << std::endl;
+    log << "Source code: \"" << source << "\"" << std::endl;
+    log << "========================================" << std::endl;
+    // The parser pulls tokens from the scanner as it goes, so both phases
+    // run together and the scanned tokens are logged as they are consumed
+    log << "--- Running Scanner and Parser ---" << std::endl;
+  }
+  // Scanning is interleaved with parsing and is measured as part of it
+  TimeReport::Scope parse_time("Parsing");
+  // Most functions of a huge file are typically never called; their bodies
+  // are only parsed once found reachable, see parseReachableBodies
+  unit.lazy_bodies = source.size() >= kLazyBodyThreshold;
+  // Huge files are lexed on all cores first. Large ones are lexed up front
+  // too when there are cores to parse their top-level declarations on. The
+  // token dump is written by the streaming path, so debug runs always
+  // stream.
+  const bool parallel_scan = !debug && source.size() >= kParallelScanThreshold;
+  const bool parallel_parse = !debug &&
+                              source.size() >= kParallelParseThreshold &&
+                              std::thread::hardware_concurrency() > 1;
+  if (parallel_scan || parallel_parse) {
+    std::vector<LoomToken> tokens =
+        scanParallel(source, filename, parallel_scan ? 0 : 1);
+    ParallelParseResult result = parseParallel(
+        tokens, *unit.file, unit.diagnostics, unit.lazy_bodies);
+    unit.ast = std::move(result.statements);
+    unit.range_arenas = std::move(result.arenas);
+    unit.had_error = result.had_error;
+    return;
+  }
+  Scanner scanner(source, filename);
+  TokenStream tokens(scanner, debug ? &log : nullptr);
+  Parser parser(tokens, *unit.file, unit.arena, unit.diagnostics);
+  parser.setLazyFunctionBodies(unit.lazy_bodies);
+  unit.ast = parser.parse();
+  unit.had_error = parser.hasError();
+}
+
+// Prints the --time-report summary and writes the --time-trace file when
+// runDriver returns, whichever way it returns
+struct TimeReportPrinter {
+  bool json = false;
+  std::string trace_path;  // --time-trace output, empty if not tracing
+  ~TimeReportPrinter() {
+    if (!trace_path.empty()) {
+      TimeReport::finishTimeTrace(trace_path);
+    }
+    if (!TimeReport::isEnabled()) return;
+    std::cout.flush();
+    if (json) {
+      TimeReport::printJSON(std::cerr);
+    } else {
+      TimeReport::printTable(std::cerr);
+    }
+  }
+};
+
+int runDriver(const std::vector<std::string>& args) {
+  TimeReportPrinter time_report_printer;
+  std::vector<std::string> filenames;
+  OptLevel opt_level = OptLevel::O0;
+
+  // "loom run <file>" executes main in-process through the JIT instead of
+  // producing an executable
+  size_t first_arg = 0;
+  bool run_mode = false;
+  bool use_cache = true;
+  bool trace_requested = false;
+  bool print_ir = false;
+  if (!args.empty() && args[0] == "run") {
+    run_mode = true;
+    first_arg = 1;
+  }
+
+  for (size_t i = first_arg; i < args.size(); ++i) {
+    const std::string& arg = args[i];
+    if (arg.rfind("-O", 0) == 0) {
+      if (!parseOptLevel(arg, opt_level)) {
+        LOOM_ERROR("Unknown optimization level '", arg,
+                   "' (expected -O0, -O1, -O2, -O3 or -Os)");
+        return 1;
+      }
+    } else if (arg == "-q" || arg == "--quiet") {
+      Logger::setLevel(LogLevel::ERROR);
+    } else if (arg == "-v" || arg == "--verbose") {
+      Logger::setLevel(LogLevel::INFO);
+    } else if (arg == "--debug") {
+      Logger::setLevel(LogLevel::DEBUG);
+    } else if (arg == "--print-ir") {
+      print_ir = true;
+    } else if (arg == "--no-cache") {
+      use_cache = false;
+    } else if (arg == "--time-report" || arg == "--time-report=table") {
+      TimeReport::setEnabled(true);
+    } else if (arg == "--time-report=json") {
+      TimeReport::setEnabled(true);
+      time_report_printer.json = true;
+    } else if (arg == "--time-trace") {
+      trace_requested = true;
+    } else if (arg.rfind("--time-trace=", 0) == 0) {
+      trace_requested = true;
+      time_report_printer.trace_path = arg.substr(13);
+    } else {
+      filenames.push_back(arg);
+    }
+  }
+
+  if (trace_requested) {
+    // Like clang's -ftime-trace: default to a file named after the input
+    if (time_report_printer.trace_path.empty()) {
+      std::string stem = filenames.empty() ? "loom" : filenames[0];
+      size_t dot = stem.find_last_of('.');
+      if (dot != std::string::npos) stem = stem.substr(0, dot);
+      time_report_printer.trace_path = stem + ".time-trace.json";
+    }
+    TimeReport::startTimeTrace();
+  }
+
+  // Everything after option parsing; destroyed before the report is printed
+  TimeReport::Scope total_time("Total");
+
+  // Owns the source buffers; everything below points into them
+  SourceManager source_manager;
+  // Units are created up front and never reallocated, since worker threads
+  // fill them in place
+  std::vector<TranslationUnit> units(std::max<size_t>(filenames.size(), 1));
+  if (filenames.empty()) {
+    // No file provided, use default test code
+    LOOM_INFO("No file provided, using default test code.");
+    units[0].file = source_manager.addBuffer(
+        "inline_test.loom", "let x = 10; let y = 32; let z = x + y;");
+  } else {
+    TimeReport::Scope time_scope("Reading sources");
+    for (size_t i = 0; i < filenames.size(); ++i) {
+      units[i].file = source_manager.loadFile(filenames[i]);
+
+      if (!units[i].file || units[i].file->getText().empty()) {
+        LOOM_ERROR("Failed to read file '", filenames[i],
+                   "' or file is empty.");
+        return 1;
+      }
+      if (units[i].file->getText().size() > kMaxSourceSize) {
+        LOOM_ERROR("File '", filenames[i], "' is larger than 4 GiB");
+        return 1;
+      }
+    }
+  }
+
+  CodeGen code_generator;
+  code_generator.setOptimizationLevel(opt_level);
+  code_generator.setJITMode(run_mode);
+
+  // Generate output filename from the first file (replace .loom with .exe)
+  std::string output_name(units[0].file->getFilename());
+  size_t last_dot = output_name.find_last_of('.');
+  if (last_dot != std::string::npos) {
+    output_name = output_name.substr(0, last_dot);
+  }
+  output_name += ".exe";
+
+  // Unchanged inputs are served from the compilation cache before any
+  // phase runs. "loom run" never produces an object, so it skips the cache,
+  // as does a compiler that can't tell its own build apart from others.
+  std::unique_ptr<CompileCache> cache;
+  std::string cache_key;
+  if (use_cache && !run_mode && CompileCache::buildIdentity()) {
+    TimeReport::Scope time_scope("Cache lookup");
+    cache = std::make_unique<CompileCache>(CompileCache::defaultDirectory());
+    std::vector<std::string_view> sources;
+    for (const auto& unit : units) {
+      sources.push_back(unit.file->getText());
+    }
+    cache_key = CompileCache::computeKey(
+        sources, code_generator.getTargetDescription() + " " +
+                     code_generator.getLinkerDescription());
+
+    if (cache->lookupExecutable(cache_key, output_name)) {
+      std::cout << "Successfully compiled to: " << output_name << " (cached)"
+                << std::endl;
+      return 0;
+    }
+    llvm::SmallVector<char, 0> cached_object;
+    if (cache->lookupObject(cache_key, cached_object)) {
+      if (!code_generator.compileToExecutable(cached_object, output_name)) {
+        LOOM_ERROR("Failed to link executable");
+        return 1;
+      }
+      cache->storeExecutable(cache_key, output_name);
+      std::cout << "Successfully compiled to: " << output_name << " (cached)"
+                << std::endl;
+      return 0;
+    }
+  }
+
+  // Scanning and parsing are independent per file, so every unit gets its
+  // own job. A single file is handled on the main thread.
+  if (units.size() == 1) {
+    runFrontend(units[0]);
+  } else {
+    ThreadPool pool(static_cast<unsigned>(
+        std::min<size_t>(units.size(), std::thread::hardware_concurrency())));
+    std::vector<std::future<void>> jobs;
+    jobs.reserve(units.size());
+    for (auto& unit : units) {
+      jobs.push_back(pool.submit([&unit]() {
+        TimeReport::ThreadTrace thread_trace;
+        runFrontend(unit);
+      }));
+    }
+    for (auto& job : jobs) {
+      job.get();
+    }
+  }
+
+  // Merge all declarations into one program for sema and codegen
+  bool parse_failed = false;
+  bool lazy_bodies = false;
+  std::vector<StmtNode*> ast;
+  for (auto& unit : units) {
+    std::cout << unit.log.str();
+    std::cerr << unit.diagnostics.str();
+    parse_failed = parse_failed || unit.had_error;
+    lazy_bodies = lazy_bodies || unit.lazy_bodies;
+    ast.insert(ast.end(), unit.ast.begin(), unit.ast.end());
+  }
+
+  // Parse the skipped bodies that can run. This needs the whole program,
+  // so it runs after all units; the nodes go to an arena of their own.
+  Arena body_arena;
+  if (!parse_failed && lazy_bodies) {
+    TimeReport::Scope time_scope("Parsing function bodies");
+    parse_failed = !parseReachableBodies(ast, [&](FunctionDeclNode& func) {
+      return parseSkippedBody(func, source_manager.getFile(func.body_begin),
+                              body_arena, std::cerr);
+    });
+  }
+
+  // --- PHASE 3: SEMANTIC ANALYSIS ---
+  if (!parse_failed) {
+    LOOM_INFO("--- Running Semantic Analyzer ---");
+    // Types sema infers end up in the AST, so they stay until codegen is done
+    Arena type_arena;
+    SemanticAnalyzer sema(type_arena, source_manager);
+    {
+      TimeReport::Scope time_scope("Semantic analysis");
+      sema.analyze(ast);
+    }
+
+    if (!sema.hasError()) {
+      LOOM_INFO("Semantic analysis successful!");
+      // --- PHASE 4: CODE GENERATION (NEU) ---
+      LOOM_INFO("--- Running Code Generator ---");
+      {
+        TimeReport::Scope time_scope("IR generation");
+        // CodeGen reports unsupported programs (e.g. no main) by throwing
+        try {
+          code_generator.generate(ast);
+        } catch (const std::runtime_error& e) {
+          LOOM_ERROR("Code generation failed: ", e.what());
+          return 1;
+        }
+      }
+
+      if (print_ir || Logger::isEnabled(LogLevel::DEBUG)) {
+        std::cout << "--- Generated LLVM IR ---" << std::endl;
+        code_generator.print_ir();
+        std::cout << "-------------------------" << std::endl;
+      }
+      // --- PHASE 5: COMPILE TO EXECUTABLE (INTEGRATED LLVM APPROACH) ---
+      if (run_mode) {
+        LOOM_INFO("--- Running with JIT ---");
+        {
+          TimeReport::Scope time_scope("LLVM target setup");
+          if (!code_generator.initializeLLVMTargets()) {
+            LOOM_ERROR("Failed to initialize LLVM targets");
+            return 1;
+          }
+        }
+        int exit_code = 0;
+        if (!code_generator.runJIT(exit_code)) {
+          LOOM_ERROR("Failed to run program");
+          return 1;
+        }
+        return exit_code;
+      }
+
+      LOOM_INFO("--- Compiling to Executable ---");
+
+      // Initialize LLVM targets for object file generation
+      {
+        TimeReport::Scope time_scope("LLVM target setup");
+        if (!code_generator.initializeLLVMTargets()) {
+          LOOM_ERROR("Failed to initialize LLVM targets");
+          return 1;
+        }
+      }
+
+      // Generate the object file in memory; it is handed straight to the
+      // linker without a temporary .o on disk
+      llvm::SmallVector<char, 0> object_buffer;
+      if (!code_generator.compileToObjectFile(object_buffer)) {
+        LOOM_ERROR("Failed to generate object file");
+        return 1;
+      }
+      if (cache) {
+        cache->storeObject(cache_key, object_buffer);
+      }
+
+      // Link object file to executable
+      if (!code_generator.compileToExecutable(object_buffer, output_name)) {
+        LOOM_ERROR("Failed to link executable");
+        return 1;
+      }
+      if (cache) {
+        cache->storeExecutable(cache_key, output_name);
+      }
+
+      std::cout << "Successfully compiled to: " << output_name << std::endl;
+    } else {
+      LOOM_ERROR("Semantic analysis failed!");
+      return 1;  // Exit with error code when semantic analysis fails
+    }
+    LOOM_INFO("--- Semantic Analyzer Finished ---");
+  } else {
+    LOOM_ERROR("Parsing failed!");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,12 @@
+// compiler/driver/driver.hh
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Runs one compiler invocation: scanning, parsing, sema, codegen and
+// linking (or JIT execution for "run"). args are the command line without
+// the program name. Returns the process exit code.
+//
+// Used by the loom executable and by each request of the compile server.
+int runDriver(const std::vector<std::string>& args);
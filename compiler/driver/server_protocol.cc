@@ -0,0 +1,235 @@
+#include "server_protocol.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// Identifies the protocol revision; bump when the framing changes
+static const uint32_t protocol_magic = 0x4c4f4f31;  // "LOO1"
+// Largest working directory plus arguments a server accepts
+static const uint32_t max_payload_size = uint32_t{16} << 20;
+
+std::string defaultServerSocketPath() {
+  if (const char* env = std::getenv("LOOM_SERVER_SOCKET")) {
+    if (*env) return env;
+  }
+  if (const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR")) {
+    if (*runtime_dir) return std::string(runtime_dir) + "/loom.sock";
+  }
+#ifndef _WIN32
+  return "/tmp/loom-" + std::to_string(getuid()) + ".sock";
+#else
+  return "";
+#endif
+}
+
+#ifndef _WIN32
+
+static bool writeAll(int fd, const void* data, size_t size) {
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t written = write(fd, bytes, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    bytes += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+static bool readAll(int fd, void* data, size_t size) {
+  char* bytes = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t received = read(fd, bytes, size);
+    if (received < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (received == 0) return false;  // peer closed early
+    bytes += received;
+    size -= static_cast<size_t>(received);
+  }
+  return true;
+}
+
+static void appendString(std::string& payload, const std::string& value) {
+  uint32_t size = static_cast<uint32_t>(value.size());
+  payload.append(reinterpret_cast<const char*>(&size), sizeof(size));
+  payload.append(value);
+}
+
+static bool takeString(const std::string& payload, size_t& pos,
+                       std::string& value) {
+  uint32_t size;
+  if (payload.size() - pos < sizeof(size)) return false;
+  std::memcpy(&size, payload.data() + pos, sizeof(size));
+  pos += sizeof(size);
+  if (payload.size() - pos < size) return false;
+  value.assign(payload, pos, size);
+  pos += size;
+  return true;
+}
+
+int connectToServer(const std::string& socket_path) {
+  sockaddr_un address{};
+  if (socket_path.size() >= sizeof(address.sun_path)) return -1;
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+  if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) <
+          0 ||
+      !peerIsCurrentUser(fd)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool peerIsCurrentUser(int socket_fd) {
+#ifdef __linux__
+  ucred credentials{};
+  socklen_t size = sizeof(credentials);
+  if (getsockopt(socket_fd, SOL_SOCKET, SO_PEERCRED, &credentials, &size) <
+      0) {
+    return false;
+  }
+  return credentials.uid == geteuid();
+#else
+  uid_t uid;
+  gid_t gid;
+  if (getpeereid(socket_fd, &uid, &gid) < 0) return false;
+  return uid == geteuid();
+#endif
+}
+
+bool sendRequest(int socket_fd, const std::vector<std::string>& args) {
+  char cwd_buffer[4096];
+  if (!getcwd(cwd_buffer, sizeof(cwd_buffer))) return false;
+
+  std::string payload;
+  appendString(payload, cwd_buffer);
+  for (const auto& arg : args) {
+    appendString(payload, arg);
+  }
+
+  uint32_t header[3] = {protocol_magic, static_cast<uint32_t>(args.size()),
+                        static_cast<uint32_t>(payload.size())};
+  iovec header_io{header, sizeof(header)};
+
+  int fds[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+  msghdr message{};
+  message.msg_iov = &header_io;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr* fd_message = CMSG_FIRSTHDR(&message);
+  fd_message->cmsg_level = SOL_SOCKET;
+  fd_message->cmsg_type = SCM_RIGHTS;
+  fd_message->cmsg_len = CMSG_LEN(sizeof(fds));
+  std::memcpy(CMSG_DATA(fd_message), fds, sizeof(fds));
+
+  ssize_t sent;
+  do {
+    sent = sendmsg(socket_fd, &message, 0);
+  } while (sent < 0 && errno == EINTR);
+  if (sent != static_cast<ssize_t>(sizeof(header))) return false;
+
+  return writeAll(socket_fd, payload.data(), payload.size());
+}
+
+// Reads the working directory and arguments that follow the header
+static bool receivePayload(int socket_fd, uint32_t arg_count,
+                           uint32_t payload_size, CompileRequest& request) {
+  if (payload_size > max_payload_size) return false;
+  std::string payload(payload_size, '\0');
+  if (!readAll(socket_fd, payload.data(), payload.size())) return false;
+
+  size_t pos = 0;
+  if (!takeString(payload, pos, request.working_directory)) return false;
+  // Every argument takes at least its length field, so a larger count
+  // can't be honest; don't allocate for it
+  if (arg_count > (payload.size() - pos) / sizeof(uint32_t)) return false;
+  request.args.resize(arg_count);
+  for (auto& arg : request.args) {
+    if (!takeString(payload, pos, arg)) return false;
+  }
+  return pos == payload.size();
+}
+
+bool receiveRequest(int socket_fd, CompileRequest& request) {
+  uint32_t header[3];
+  iovec header_io{header, sizeof(header)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(request.fds))] = {};
+  msghdr message{};
+  message.msg_iov = &header_io;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  ssize_t received;
+  do {
+    received = recvmsg(socket_fd, &message, MSG_CMSG_CLOEXEC | MSG_WAITALL);
+  } while (received < 0 && errno == EINTR);
+  if (received < 0) return false;
+
+  // Take whatever descriptors arrived first, so a malformed request can't
+  // leave them open in the server
+  int fd_count = 0;
+  cmsghdr* fd_message = CMSG_FIRSTHDR(&message);
+  if (fd_message && fd_message->cmsg_level == SOL_SOCKET &&
+      fd_message->cmsg_type == SCM_RIGHTS) {
+    fd_count = static_cast<int>((fd_message->cmsg_len - CMSG_LEN(0)) /
+                                sizeof(int));
+    fd_count = std::min(fd_count, 3);
+    std::memcpy(request.fds, CMSG_DATA(fd_message),
+                static_cast<size_t>(fd_count) * sizeof(int));
+  }
+
+  if (received != static_cast<ssize_t>(sizeof(header)) ||
+      header[0] != protocol_magic || fd_count != 3 ||
+      (message.msg_flags & MSG_CTRUNC) ||
+      !receivePayload(socket_fd, header[1], header[2], request)) {
+    for (int& fd : request.fds) {
+      if (fd >= 0) close(fd);
+      fd = -1;
+    }
+    return false;
+  }
+  return true;
+}
+
+bool sendExitCode(int socket_fd, int exit_code) {
+  int32_t code = exit_code;
+  return writeAll(socket_fd, &code, sizeof(code));
+}
+
+bool receiveExitCode(int socket_fd, int& exit_code) {
+  int32_t code;
+  if (!readAll(socket_fd, &code, sizeof(code))) return false;
+  exit_code = code;
+  return true;
+}
+
+#else  // _WIN32: no Unix domain socket support yet
+
+int connectToServer(const std::string&) { return -1; }
+bool peerIsCurrentUser(int) { return false; }
+bool sendRequest(int, const std::vector<std::string>&) { return false; }
+bool receiveExitCode(int, int&) { return false; }
+bool receiveRequest(int, CompileRequest&) { return false; }
+bool sendExitCode(int, int) { return false; }
+
+#endif
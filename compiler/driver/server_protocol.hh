@@ -0,0 +1,41 @@
+// compiler/driver/server_protocol.hh
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Wire protocol between loom-client and "loom --server" over a local Unix
+// socket. It deliberately has no LLVM dependency so the client stays thin.
+//
+// A request is one header message carrying the client's stdin, stdout and
+// stderr as SCM_RIGHTS ancillary data, followed by the working directory
+// and the command line arguments. The server replies with the exit code
+// once the compilation finished; all output goes straight to the passed
+// descriptors.
+
+struct CompileRequest {
+  std::string working_directory;
+  std::vector<std::string> args;
+  int fds[3] = {-1, -1, -1};  // client's stdin, stdout, stderr
+};
+
+// $LOOM_SERVER_SOCKET, otherwise $XDG_RUNTIME_DIR/loom.sock, otherwise
+// /tmp/loom-<uid>.sock
+std::string defaultServerSocketPath();
+
+// Returns a connected socket, or -1 if no server is listening. A listener
+// running as another user counts as none: the request would hand it our
+// stdio.
+int connectToServer(const std::string& socket_path);
+
+// Whether the process at the other end of a connected Unix socket runs as
+// our effective user
+bool peerIsCurrentUser(int socket_fd);
+
+// Client side: forwards args, the current directory and stdio
+bool sendRequest(int socket_fd, const std::vector<std::string>& args);
+bool receiveExitCode(int socket_fd, int& exit_code);
+
+// Server side
+bool receiveRequest(int socket_fd, CompileRequest& request);
+bool sendExitCode(int socket_fd, int exit_code);
@@ -1,14 +1,105 @@
 #pragma once
 
-#include <memory>
+#include <cassert>
+#include <cstdint>
+#include <span>
 #include <string>
-#include <vector>
+#include <string_view>
 
+#include "../common/symbol.hh"
 #include "../scanner/scanner_internal.hh"
 
 // KORREKTUR 1: Enum an den Anfang der Datei
 enum class VarDeclKind { LET, MUT, DEFINE };
 
+// Nodes are allocated in the Arena of their compilation unit (types that
+// sema infers in the arena sema is given) and never destroyed one by one:
+// children are plain pointers, child lists are arrays in the same arena,
+// and strings point into the source buffer. The whole tree goes away when
+// the arena does, so it must outlive every phase using the AST.
+template <typename T>
+using NodeList = std::span<T*>;
+
+// Spelling of a unary or binary operator, for dumps and diagnostics
+inline const char* operatorSpelling(TokenType op) {
+  switch (op) {
+    case TokenType::TOKEN_PLUS:
+      return "+";
+    case TokenType::TOKEN_MINUS:
+      return "-";
+    case TokenType::TOKEN_STAR:
+      return "*";
+    case TokenType::TOKEN_SLASH:
+      return "/";
+    case TokenType::TOKEN_BANG:
+      return "!";
+    case TokenType::TOKEN_EQUAL_EQUAL:
+      return "==";
+    case TokenType::TOKEN_LESS:
+      return "<";
+    case TokenType::TOKEN_LESS_EQUAL:
+      return "<=";
+    case TokenType::TOKEN_GREATER:
+      return ">";
+    case TokenType::TOKEN_GREATER_EQUAL:
+      return ">=";
+    default:
+      return "?";
+  }
+}
+
+// Tag of every concrete node class, named after the class. Checking it is
+// what classof/isa/dyn_cast below do instead of RTTI, and codegen
+// dispatches with a switch over it. Statements, expressions and types each
+// form a contiguous range, so keep new kinds inside their group.
+enum class NodeKind : uint8_t {
+  // Statements
+  VarDeclNode,
+  FunctionDeclNode,
+  ReturnStmtNode,
+  ExprStmtNode,
+  IfStmtNode,
+  WhileStmtNode,
+  DeferStmtNode,
+  // Expressions
+  NumberLiteral,
+  StringLiteral,
+  BooleanLiteral,
+  Identifier,
+  AssignmentExpr,
+  BinaryExpr,
+  UnaryExpr,
+  FunctionCallExpr,
+  BuiltinCallExpr,
+  ReferenceExpr,
+  DereferenceExpr,
+  MemberAccessExpr,
+  PointerAccessExpr,
+  SliceExpr,
+  UnsafeBlockExpr,
+  // Types
+  IntegerTypeNode,
+  FloatTypeNode,
+  BooleanTypeNode,
+  StringTypeNode,
+  NullTypeNode,
+  IntegerLiteralTypeNode,
+  FloatLiteralTypeNode,
+  ReferenceTypeNode,
+  OwnedPointerTypeNode,
+  NullableTypeNode,
+  SliceTypeNode,
+  // Neither statement nor expression
+  ParameterNode,
+
+  FirstStmt = VarDeclNode,
+  LastStmt = DeferStmtNode,
+  FirstExpr = NumberLiteral,
+  LastExpr = UnsafeBlockExpr,
+  FirstType = IntegerTypeNode,
+  LastType = SliceTypeNode,
+};
+
 // Forward-Deklarationen für den Visitor
 class NumberLiteral;
 class Identifier;
@@ -50,67 +141,119 @@ class UnsafeBlockExpr;
 class ASTVisitor {
  public:
   virtual ~ASTVisitor() = default;
-  virtual std::unique_ptr<TypeNode> visit(NumberLiteral& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(StringLiteral& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(BooleanLiteral& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(Identifier& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(AssignmentExpr& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(BinaryExpr& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(UnaryExpr& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(VarDeclNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(FunctionDeclNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(ParameterNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(ReturnStmtNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(ExprStmtNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(IfStmtNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(WhileStmtNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(FunctionCallExpr& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(BuiltinCallExpr& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(TypeNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(IntegerTypeNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(FloatTypeNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(BooleanTypeNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(StringTypeNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(NullTypeNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(IntegerLiteralTypeNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(FloatLiteralTypeNode& node) = 0;
+  virtual TypeNode* visit(NumberLiteral& node) = 0;
+  virtual TypeNode* visit(StringLiteral& node) = 0;
+  virtual TypeNode* visit(BooleanLiteral& node) = 0;
+  virtual TypeNode* visit(Identifier& node) = 0;
+  virtual TypeNode* visit(AssignmentExpr& node) = 0;
+  virtual TypeNode* visit(BinaryExpr& node) = 0;
+  virtual TypeNode* visit(UnaryExpr& node) = 0;
+  virtual TypeNode* visit(VarDeclNode& node) = 0;
+  virtual TypeNode* visit(FunctionDeclNode& node) = 0;
+  virtual TypeNode* visit(ParameterNode& node) = 0;
+  virtual TypeNode* visit(ReturnStmtNode& node) = 0;
+  virtual TypeNode* visit(ExprStmtNode& node) = 0;
+  virtual TypeNode* visit(IfStmtNode& node) = 0;
+  virtual TypeNode* visit(WhileStmtNode& node) = 0;
+  virtual TypeNode* visit(FunctionCallExpr& node) = 0;
+  virtual TypeNode* visit(BuiltinCallExpr& node) = 0;
+  virtual TypeNode* visit(TypeNode& node) = 0;
+  virtual TypeNode* visit(IntegerTypeNode& node) = 0;
+  virtual TypeNode* visit(FloatTypeNode& node) = 0;
+  virtual TypeNode* visit(BooleanTypeNode& node) = 0;
+  virtual TypeNode* visit(StringTypeNode& node) = 0;
+  virtual TypeNode* visit(NullTypeNode& node) = 0;
+  virtual TypeNode* visit(IntegerLiteralTypeNode& node) = 0;
+  virtual TypeNode* visit(FloatLiteralTypeNode& node) = 0;
 
   // Memory model visitors
-  virtual std::unique_ptr<TypeNode> visit(ReferenceTypeNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(OwnedPointerTypeNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(NullableTypeNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(SliceTypeNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(ReferenceExpr& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(DereferenceExpr& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(MemberAccessExpr& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(PointerAccessExpr& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(SliceExpr& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(DeferStmtNode& node) = 0;
-  virtual std::unique_ptr<TypeNode> visit(UnsafeBlockExpr& node) = 0;
+  virtual TypeNode* visit(ReferenceTypeNode& node) = 0;
+  virtual TypeNode* visit(OwnedPointerTypeNode& node) = 0;
+  virtual TypeNode* visit(NullableTypeNode& node) = 0;
+  virtual TypeNode* visit(SliceTypeNode& node) = 0;
+  virtual TypeNode* visit(ReferenceExpr& node) = 0;
+  virtual TypeNode* visit(DereferenceExpr& node) = 0;
+  virtual TypeNode* visit(MemberAccessExpr& node) = 0;
+  virtual TypeNode* visit(PointerAccessExpr& node) = 0;
+  virtual TypeNode* visit(SliceExpr& node) = 0;
+  virtual TypeNode* visit(DeferStmtNode& node) = 0;
+  virtual TypeNode* visit(UnsafeBlockExpr& node) = 0;
 };
 
 // Basisklasse
 class ASTNode {
  public:
-  virtual ~ASTNode() = default;
   LoomSourceLocation location;
   virtual std::string toString() const = 0;
   // Es gibt nur noch EINE accept-Methode
-  virtual std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) = 0;
+  virtual TypeNode* accept(ASTVisitor& visitor) = 0;
+
+  NodeKind getKind() const { return node_kind; }
 
  protected:
-  ASTNode(const LoomSourceLocation& loc) : location(loc) {}
+  ASTNode(NodeKind k, const LoomSourceLocation& loc)
+      : location(loc), node_kind(k) {}
+  // Not virtual: nodes live in an Arena and are never deleted. Concrete
+  // node classes are final, so none can be deleted through a base either.
+  ~ASTNode() = default;
+
+ private:
+  NodeKind node_kind;
 };
 
+// LLVM-style casts over NodeKind. Every node class has a static
+// classof(const ASTNode*) telling whether a node is one of it.
+template <typename To, typename From>
+bool isa(const From* node) {
+  assert(node && "isa<> on a null node");
+  return To::classof(node);
+}
+
+// Like static_cast, but asserts the kind
+template <typename To, typename From>
+To* cast(From* node) {
+  assert(isa<To>(node) && "cast<> to the wrong node kind");
+  return static_cast<To*>(node);
+}
+template <typename To, typename From>
+const To* cast(const From* node) {
+  assert(isa<To>(node) && "cast<> to the wrong node kind");
+  return static_cast<const To*>(node);
+}
+
+// Null if node is null or not a To
+template <typename To, typename From>
+To* dyn_cast(From* node) {
+  return node && isa<To>(node) ? static_cast<To*>(node) : nullptr;
+}
+template <typename To, typename From>
+const To* dyn_cast(const From* node) {
+  return node && isa<To>(node) ? static_cast<const To*>(node) : nullptr;
+}
+
 // Zwischen-Basisklassen
 class StmtNode : public ASTNode {
+ public:
+  static bool classof(const ASTNode* node) {
+    return node->getKind() >= NodeKind::FirstStmt &&
+           node->getKind() <= NodeKind::LastStmt;
+  }
+
  protected:
   using ASTNode::ASTNode;
+  ~StmtNode() = default;
 };
 
 class ExprNode : public ASTNode {
+ public:
+  static bool classof(const ASTNode* node) {
+    return node->getKind() >= NodeKind::FirstExpr &&
+           node->getKind() <= NodeKind::LastExpr;
+  }
+
  protected:
   using ASTNode::ASTNode;
+  ~ExprNode() = default;
 };
 
 // Base type node - now abstract
@@ -121,19 +264,27 @@ class TypeNode : public ASTNode {
   // New method to check if this type can accept a value from another type
   virtual bool canAcceptFrom(const TypeNode* other) const = 0;
 
+  static bool classof(const ASTNode* node) {
+    return node->getKind() >= NodeKind::FirstType &&
+           node->getKind() <= NodeKind::LastType;
+  }
+
  protected:
   using ASTNode::ASTNode;
+  ~TypeNode() = default;
 };
 
 // Integer types (i8, i16, i32, i64)
-class IntegerTypeNode : public TypeNode {
+class IntegerTypeNode final : public TypeNode {
  public:
   int bit_width;
   bool is_signed;
 
   IntegerTypeNode(const LoomSourceLocation& loc, int width,
                   bool signed_type = true)
-      : TypeNode(loc), bit_width(width), is_signed(signed_type) {}
+      : TypeNode(NodeKind::IntegerTypeNode, loc),
+        bit_width(width),
+        is_signed(signed_type) {}
 
   std::string toString() const override {
     return (is_signed ? "i" : "u") + std::to_string(bit_width);
@@ -143,7 +294,7 @@ class IntegerTypeNode : public TypeNode {
     return (is_signed ? "i" : "u") + std::to_string(bit_width);
   }
   bool isEqualTo(const TypeNode* other) const override {
-    if (auto other_int = dynamic_cast<const IntegerTypeNode*>(other)) {
+    if (auto other_int = dyn_cast<IntegerTypeNode>(other)) {
       return this->bit_width == other_int->bit_width &&
              this->is_signed == other_int->is_signed;
     }
@@ -160,18 +311,22 @@ class IntegerTypeNode : public TypeNode {
     return false;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::IntegerTypeNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Float types (f16, f32, f64)
-class FloatTypeNode : public TypeNode {
+class FloatTypeNode final : public TypeNode {
  public:
   int bit_width;
 
   FloatTypeNode(const LoomSourceLocation& loc, int width)
-      : TypeNode(loc), bit_width(width) {}
+      : TypeNode(NodeKind::FloatTypeNode, loc), bit_width(width) {}
 
   std::string toString() const override {
     return "f" + std::to_string(bit_width);
@@ -181,7 +336,7 @@ class FloatTypeNode : public TypeNode {
     return "f" + std::to_string(bit_width);
   }
   bool isEqualTo(const TypeNode* other) const override {
-    if (auto other_float = dynamic_cast<const FloatTypeNode*>(other)) {
+    if (auto other_float = dyn_cast<FloatTypeNode>(other)) {
       return this->bit_width == other_float->bit_width;
     }
     return false;
@@ -196,82 +351,101 @@ class FloatTypeNode : public TypeNode {
     return false;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::FloatTypeNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Boolean type
-class BooleanTypeNode : public TypeNode {
+class BooleanTypeNode final : public TypeNode {
  public:
-  BooleanTypeNode(const LoomSourceLocation& loc) : TypeNode(loc) {}
+  BooleanTypeNode(const LoomSourceLocation& loc)
+      : TypeNode(NodeKind::BooleanTypeNode, loc) {}
 
   std::string toString() const override { return "bool"; }
 
   std::string getTypeName() const override { return "bool"; }
   bool isEqualTo(const TypeNode* other) const override {
-    return dynamic_cast<const BooleanTypeNode*>(other) != nullptr;
+    return other && isa<BooleanTypeNode>(other);
   }
 
   bool canAcceptFrom(const TypeNode* other) const override {
     return isEqualTo(other);
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::BooleanTypeNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // String type
-class StringTypeNode : public TypeNode {
+class StringTypeNode final : public TypeNode {
  public:
-  StringTypeNode(const LoomSourceLocation& loc) : TypeNode(loc) {}
+  StringTypeNode(const LoomSourceLocation& loc)
+      : TypeNode(NodeKind::StringTypeNode, loc) {}
 
   std::string toString() const override { return "string"; }
 
   std::string getTypeName() const override { return "string"; }
   bool isEqualTo(const TypeNode* other) const override {
-    return dynamic_cast<const StringTypeNode*>(other) != nullptr;
+    return other && isa<StringTypeNode>(other);
   }
 
   bool canAcceptFrom(const TypeNode* other) const override {
     return isEqualTo(other);
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::StringTypeNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Null type - represents the type of null literals
-class NullTypeNode : public TypeNode {
+class NullTypeNode final : public TypeNode {
  public:
-  NullTypeNode(const LoomSourceLocation& loc) : TypeNode(loc) {}
+  NullTypeNode(const LoomSourceLocation& loc)
+      : TypeNode(NodeKind::NullTypeNode, loc) {}
 
   std::string toString() const override { return "null"; }
 
   std::string getTypeName() const override { return "null"; }
 
   bool isEqualTo(const TypeNode* other) const override {
-    return dynamic_cast<const NullTypeNode*>(other) != nullptr;
+    return other && isa<NullTypeNode>(other);
   }
 
   bool canAcceptFrom(const TypeNode* other) const override {
     return isEqualTo(other);
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::NullTypeNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Special type for integer literals that can be converted to appropriate types
-class IntegerLiteralTypeNode : public TypeNode {
+class IntegerLiteralTypeNode final : public TypeNode {
  public:
-  long long value;  // Store the actual literal value
+  uint64_t value;  // Store the actual literal value; negation is an operator
 
-  IntegerLiteralTypeNode(const LoomSourceLocation& loc, long long val)
-      : TypeNode(loc), value(val) {}
+  IntegerLiteralTypeNode(const LoomSourceLocation& loc, uint64_t val)
+      : TypeNode(NodeKind::IntegerLiteralTypeNode, loc), value(val) {}
 
   std::string toString() const override {
     return "IntegerLiteral(" + std::to_string(value) + ")";
@@ -280,7 +454,7 @@ class IntegerLiteralTypeNode : public TypeNode {
   std::string getTypeName() const override { return "literal_int"; }
 
   bool isEqualTo(const TypeNode* other) const override {
-    if (auto other_lit = dynamic_cast<const IntegerLiteralTypeNode*>(other)) {
+    if (auto other_lit = dyn_cast<IntegerLiteralTypeNode>(other)) {
       return this->value == other_lit->value;
     }
     return false;
@@ -295,46 +469,49 @@ class IntegerLiteralTypeNode : public TypeNode {
     if (target->is_signed) {
       switch (target->bit_width) {
         case 8:
-          return value >= -128 && value <= 127;
+          return value <= 127;
         case 16:
-          return value >= -32768 && value <= 32767;
+          return value <= 32767;
         case 32:
-          return value >= -2147483648LL && value <= 2147483647LL;
+          return value <= 2147483647ULL;
         case 64:
-          return true;  // long long can always fit in i64
+          return value <= 9223372036854775807ULL;
         default:
           return false;
       }
     } else {
       // Unsigned integers
-      if (value < 0) return false;  // Can't fit negative values in unsigned
       switch (target->bit_width) {
         case 8:
           return value <= 255;
         case 16:
           return value <= 65535;
         case 32:
-          return static_cast<unsigned long long>(value) <= 4294967295ULL;
+          return value <= 4294967295ULL;
         case 64:
-          return value >= 0;  // Any non-negative long long fits in u64
+          return true;  // the scanner rejects anything wider
         default:
           return false;
       }
     }
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::IntegerLiteralTypeNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Special type for float literals that can be converted to appropriate types
-class FloatLiteralTypeNode : public TypeNode {
+class FloatLiteralTypeNode final : public TypeNode {
  public:
   double value;  // Store the actual literal value
 
   FloatLiteralTypeNode(const LoomSourceLocation& loc, double val)
-      : TypeNode(loc), value(val) {}
+      : TypeNode(NodeKind::FloatLiteralTypeNode, loc), value(val) {}
 
   std::string toString() const override {
     return "FloatLiteral(" + std::to_string(value) + ")";
@@ -343,7 +520,7 @@ class FloatLiteralTypeNode : public TypeNode {
   std::string getTypeName() const override { return "literal_float"; }
 
   bool isEqualTo(const TypeNode* other) const override {
-    if (auto other_lit = dynamic_cast<const FloatLiteralTypeNode*>(other)) {
+    if (auto other_lit = dyn_cast<FloatLiteralTypeNode>(other)) {
       return this->value == other_lit->value;
     }
     return false;
@@ -359,7 +536,11 @@ class FloatLiteralTypeNode : public TypeNode {
     return target->bit_width >= 16;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::FloatLiteralTypeNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
@@ -367,13 +548,12 @@ class FloatLiteralTypeNode : public TypeNode {
 // Memory model type nodes
 
 // Reference type: &T
-class ReferenceTypeNode : public TypeNode {
+class ReferenceTypeNode final : public TypeNode {
  public:
-  std::unique_ptr<TypeNode> referenced_type;
+  TypeNode* referenced_type;
 
-  ReferenceTypeNode(const LoomSourceLocation& loc,
-                    std::unique_ptr<TypeNode> type)
-      : TypeNode(loc), referenced_type(std::move(type)) {}
+  ReferenceTypeNode(const LoomSourceLocation& loc, TypeNode* type)
+      : TypeNode(NodeKind::ReferenceTypeNode, loc), referenced_type(type) {}
 
   std::string toString() const override {
     return "&" + referenced_type->toString();
@@ -384,8 +564,8 @@ class ReferenceTypeNode : public TypeNode {
   }
 
   bool isEqualTo(const TypeNode* other) const override {
-    if (auto other_ref = dynamic_cast<const ReferenceTypeNode*>(other)) {
-      return referenced_type->isEqualTo(other_ref->referenced_type.get());
+    if (auto other_ref = dyn_cast<ReferenceTypeNode>(other)) {
+      return referenced_type->isEqualTo(other_ref->referenced_type);
     }
     return false;
   }
@@ -394,19 +574,22 @@ class ReferenceTypeNode : public TypeNode {
     return isEqualTo(other);
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::ReferenceTypeNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Owned pointer type: ^T
-class OwnedPointerTypeNode : public TypeNode {
+class OwnedPointerTypeNode final : public TypeNode {
  public:
-  std::unique_ptr<TypeNode> pointed_type;
+  TypeNode* pointed_type;
 
-  OwnedPointerTypeNode(const LoomSourceLocation& loc,
-                       std::unique_ptr<TypeNode> type)
-      : TypeNode(loc), pointed_type(std::move(type)) {}
+  OwnedPointerTypeNode(const LoomSourceLocation& loc, TypeNode* type)
+      : TypeNode(NodeKind::OwnedPointerTypeNode, loc), pointed_type(type) {}
 
   std::string toString() const override {
     return "^" + pointed_type->toString();
@@ -417,8 +600,8 @@ class OwnedPointerTypeNode : public TypeNode {
   }
 
   bool isEqualTo(const TypeNode* other) const override {
-    if (auto other_owned = dynamic_cast<const OwnedPointerTypeNode*>(other)) {
-      return pointed_type->isEqualTo(other_owned->pointed_type.get());
+    if (auto other_owned = dyn_cast<OwnedPointerTypeNode>(other)) {
+      return pointed_type->isEqualTo(other_owned->pointed_type);
     }
     return false;
   }
@@ -427,19 +610,22 @@ class OwnedPointerTypeNode : public TypeNode {
     return isEqualTo(other);
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::OwnedPointerTypeNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Nullable type: T?
-class NullableTypeNode : public TypeNode {
+class NullableTypeNode final : public TypeNode {
  public:
-  std::unique_ptr<TypeNode> inner_type;
+  TypeNode* inner_type;
 
-  NullableTypeNode(const LoomSourceLocation& loc,
-                   std::unique_ptr<TypeNode> type)
-      : TypeNode(loc), inner_type(std::move(type)) {}
+  NullableTypeNode(const LoomSourceLocation& loc, TypeNode* type)
+      : TypeNode(NodeKind::NullableTypeNode, loc), inner_type(type) {}
 
   std::string toString() const override { return inner_type->toString() + "?"; }
 
@@ -448,8 +634,8 @@ class NullableTypeNode : public TypeNode {
   }
 
   bool isEqualTo(const TypeNode* other) const override {
-    if (auto other_nullable = dynamic_cast<const NullableTypeNode*>(other)) {
-      return inner_type->isEqualTo(other_nullable->inner_type.get());
+    if (auto other_nullable = dyn_cast<NullableTypeNode>(other)) {
+      return inner_type->isEqualTo(other_nullable->inner_type);
     }
     return false;
   }
@@ -457,21 +643,25 @@ class NullableTypeNode : public TypeNode {
     // Nullable types can accept their inner type, other nullable of same type,
     // or null
     return isEqualTo(other) || inner_type->isEqualTo(other) ||
-           dynamic_cast<const NullTypeNode*>(other) != nullptr;
+           (other && isa<NullTypeNode>(other));
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::NullableTypeNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Slice type: []T
-class SliceTypeNode : public TypeNode {
+class SliceTypeNode final : public TypeNode {
  public:
-  std::unique_ptr<TypeNode> element_type;
+  TypeNode* element_type;
 
-  SliceTypeNode(const LoomSourceLocation& loc, std::unique_ptr<TypeNode> type)
-      : TypeNode(loc), element_type(std::move(type)) {}
+  SliceTypeNode(const LoomSourceLocation& loc, TypeNode* type)
+      : TypeNode(NodeKind::SliceTypeNode, loc), element_type(type) {}
 
   std::string toString() const override {
     return "[]" + element_type->toString();
@@ -482,8 +672,8 @@ class SliceTypeNode : public TypeNode {
   }
 
   bool isEqualTo(const TypeNode* other) const override {
-    if (auto other_slice = dynamic_cast<const SliceTypeNode*>(other)) {
-      return element_type->isEqualTo(other_slice->element_type.get());
+    if (auto other_slice = dyn_cast<SliceTypeNode>(other)) {
+      return element_type->isEqualTo(other_slice->element_type);
     }
     return false;
   }
@@ -492,172 +682,228 @@ class SliceTypeNode : public TypeNode {
     return isEqualTo(other);
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::SliceTypeNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
-class NumberLiteral : public ExprNode {
+// Value as decoded by the scanner
+class NumberLiteral final : public ExprNode {
  public:
-  std::string value;
   bool is_float;
-  NumberLiteral(const LoomSourceLocation& loc, const std::string& v, bool f)
-      : ExprNode(loc), value(v), is_float(f) {}
+  uint64_t int_value = 0;
+  double float_value = 0;
+  NumberLiteral(const LoomSourceLocation& loc, uint64_t v)
+      : ExprNode(NodeKind::NumberLiteral, loc), is_float(false), int_value(v) {}
+  NumberLiteral(const LoomSourceLocation& loc, double v)
+      : ExprNode(NodeKind::NumberLiteral, loc),
+        is_float(true),
+        float_value(v) {}
   std::string toString() const override {
-    return "NumberLiteral(" + value + (is_float ? "f" : "i") + ")";
+    return "NumberLiteral(" +
+           (is_float ? std::to_string(float_value) + "f"
+                     : std::to_string(int_value) + "i") +
+           ")";
   }
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::NumberLiteral;
+  }
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
-class BooleanLiteral : public ExprNode {
+class BooleanLiteral final : public ExprNode {
  public:
   bool value;
 
   BooleanLiteral(const LoomSourceLocation& loc, bool val)
-      : ExprNode(loc), value(val) {}
+      : ExprNode(NodeKind::BooleanLiteral, loc), value(val) {}
 
   std::string toString() const override {
     return "BooleanLiteral(" + std::string(value ? "true" : "false") + ")";
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::BooleanLiteral;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
-class Identifier : public ExprNode {
+class Identifier final : public ExprNode {
  public:
-  std::string name;
-  Identifier(const LoomSourceLocation& loc, const std::string& n)
-      : ExprNode(loc), name(n) {}
-  std::string toString() const override { return "Identifier(" + name + ")"; }
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  Symbol name;
+  Identifier(const LoomSourceLocation& loc, Symbol n)
+      : ExprNode(NodeKind::Identifier, loc), name(n) {}
+  std::string toString() const override {
+    return "Identifier(" + name.str() + ")";
+  }
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::Identifier;
+  }
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
-class StringLiteral : public ExprNode {
+class StringLiteral final : public ExprNode {
  public:
-  std::string value;
-  StringLiteral(const LoomSourceLocation& loc, const std::string& v)
-      : ExprNode(loc), value(v) {}
+  std::string_view value;  // spelling including the quotes
+  StringLiteral(const LoomSourceLocation& loc, std::string_view v)
+      : ExprNode(NodeKind::StringLiteral, loc), value(v) {}
   std::string toString() const override {
-    return "StringLiteral(" + value + ")";
+    return "StringLiteral(" + std::string(value) + ")";
+  }
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::StringLiteral;
   }
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
-class AssignmentExpr : public ExprNode {
+class AssignmentExpr final : public ExprNode {
  public:
-  std::string name;
-  std::unique_ptr<ExprNode> value;
-  AssignmentExpr(const LoomSourceLocation& loc, const std::string& n,
-                 std::unique_ptr<ExprNode> v)
-      : ExprNode(loc), name(n), value(std::move(v)) {}
+  Symbol name;
+  ExprNode* value;
+  AssignmentExpr(const LoomSourceLocation& loc, Symbol n, ExprNode* v)
+      : ExprNode(NodeKind::AssignmentExpr, loc), name(n), value(v) {}
   std::string toString() const override {
-    return "Assignment(" + name + " = " + (value ? value->toString() : "null") +
-           ")";
+    return "Assignment(" + name.str() + " = " +
+           (value ? value->toString() : "null") + ")";
   }
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::AssignmentExpr;
+  }
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
-class BinaryExpr : public ExprNode {
+class BinaryExpr final : public ExprNode {
  public:
-  std::unique_ptr<ExprNode> left;
-  LoomToken op;
-  std::unique_ptr<ExprNode> right;
-  BinaryExpr(std::unique_ptr<ExprNode> l, const LoomToken& o,
-             std::unique_ptr<ExprNode> r)
-      : ExprNode(l->location), left(std::move(l)), op(o), right(std::move(r)) {}
+  ExprNode* left;
+  ExprNode* right;
+  LoomSourceLocation op_location;
+  TokenType op;
+  BinaryExpr(ExprNode* l, TokenType o, const LoomSourceLocation& o_loc,
+             ExprNode* r)
+      : ExprNode(NodeKind::BinaryExpr, l->location),
+        left(l),
+        right(r),
+        op_location(o_loc),
+        op(o) {}
   std::string toString() const override {
-    return "Binary(" + (left ? left->toString() : "null") + " " + op.value +
-           " " + (right ? right->toString() : "null") + ")";
+    return "Binary(" + (left ? left->toString() : "null") + " " +
+           operatorSpelling(op) + " " + (right ? right->toString() : "null") +
+           ")";
   }
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::BinaryExpr;
+  }
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
-class UnaryExpr : public ExprNode {
+// The node's location is the operator's
+class UnaryExpr final : public ExprNode {
  public:
-  LoomToken op;
-  std::unique_ptr<ExprNode> right;
-  UnaryExpr(const LoomToken& o, std::unique_ptr<ExprNode> r)
-      : ExprNode(o.location), op(o), right(std::move(r)) {}
+  TokenType op;
+  ExprNode* right;
+  UnaryExpr(const LoomSourceLocation& loc, TokenType o, ExprNode* r)
+      : ExprNode(NodeKind::UnaryExpr, loc), op(o), right(r) {}
   std::string toString() const override {
-    return "Unary(" + op.value + " " + (right ? right->toString() : "null") +
-           ")";
+    return "Unary(" + std::string(operatorSpelling(op)) + " " +
+           (right ? right->toString() : "null") + ")";
+  }
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::UnaryExpr;
   }
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
-class VarDeclNode : public StmtNode {
+class VarDeclNode final : public StmtNode {
  public:
-  std::string name;
+  Symbol name;
   VarDeclKind kind;
-  std::unique_ptr<TypeNode> type;
-  std::unique_ptr<ExprNode> initializer;
-  VarDeclNode(const LoomSourceLocation& loc, const std::string& n,
-              VarDeclKind k, std::unique_ptr<TypeNode> t,
-              std::unique_ptr<ExprNode> i)
-      : StmtNode(loc),
+  TypeNode* type;
+  ExprNode* initializer;
+  VarDeclNode(const LoomSourceLocation& loc, Symbol n, VarDeclKind k,
+              TypeNode* t, ExprNode* i)
+      : StmtNode(NodeKind::VarDeclNode, loc),
         name(n),
         kind(k),
-        type(std::move(t)),
-        initializer(std::move(i)) {}
+        type(t),
+        initializer(i) {}
   std::string toString() const override { /* ... */ return "VarDecl(...)"; }
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::VarDeclNode;
+  }
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Parameter node for function declarations
-class ParameterNode : public ASTNode {
+class ParameterNode final : public ASTNode {
  public:
-  std::string name;
-  std::unique_ptr<TypeNode> type;
+  Symbol name;
+  TypeNode* type;
 
-  ParameterNode(const LoomSourceLocation& loc, const std::string& param_name,
-                std::unique_ptr<TypeNode> param_type)
-      : ASTNode(loc), name(param_name), type(std::move(param_type)) {}
+  ParameterNode(const LoomSourceLocation& loc, Symbol param_name,
+                TypeNode* param_type)
+      : ASTNode(NodeKind::ParameterNode, loc),
+        name(param_name),
+        type(param_type) {}
 
   std::string toString() const override {
-    return name + ": " + (type ? type->toString() : "unknown");
+    return name.str() + ": " + (type ? type->toString() : "unknown");
+  }
+
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::ParameterNode;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Function declaration node
-class FunctionDeclNode : public StmtNode {
- public:
-  std::string name;
-  std::vector<std::unique_ptr<ParameterNode>> parameters;
-  std::unique_ptr<TypeNode> return_type;
-  std::vector<std::unique_ptr<StmtNode>> body;
-
-  FunctionDeclNode(const LoomSourceLocation& loc, const std::string& func_name,
-                   std::vector<std::unique_ptr<ParameterNode>> params,
-                   std::unique_ptr<TypeNode> ret_type,
-                   std::vector<std::unique_ptr<StmtNode>> func_body)
-      : StmtNode(loc),
+class FunctionDeclNode final : public StmtNode {
+ public:
+  Symbol name;
+  NodeList<ParameterNode> parameters;
+  TypeNode* return_type;
+  NodeList<StmtNode> body;
+  // Set while the body hasn't been parsed yet (see
+  // Parser::setLazyFunctionBodies). body is empty until then, and
+  // body_begin and body_length cover its source from '{' to '}'.
+  bool body_pending = false;
+  LoomSourceLocation body_begin;
+  uint32_t body_length = 0;
+
+  FunctionDeclNode(const LoomSourceLocation& loc, Symbol func_name,
+                   NodeList<ParameterNode> params, TypeNode* ret_type,
+                   NodeList<StmtNode> func_body)
+      : StmtNode(NodeKind::FunctionDeclNode, loc),
         name(func_name),
-        parameters(std::move(params)),
-        return_type(std::move(ret_type)),
-        body(std::move(func_body)) {}
+        parameters(params),
+        return_type(ret_type),
+        body(func_body) {}
 
   std::string toString() const override {
-    std::string result = "FunctionDecl(" + name + "(";
+    std::string result = "FunctionDecl(" + name.str() + "(";
     for (size_t i = 0; i < parameters.size(); ++i) {
       if (i > 0) result += ", ";
       result += parameters[i] ? parameters[i]->toString() : "null";
@@ -673,19 +919,22 @@ class FunctionDeclNode : public StmtNode {
     return result;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::FunctionDeclNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Return statement node
-class ReturnStmtNode : public StmtNode {
+class ReturnStmtNode final : public StmtNode {
  public:
-  std::unique_ptr<ExprNode> expression;  // null for void returns
+  ExprNode* expression;  // null for void returns
 
-  ReturnStmtNode(const LoomSourceLocation& loc,
-                 std::unique_ptr<ExprNode> expr = nullptr)
-      : StmtNode(loc), expression(std::move(expr)) {}
+  ReturnStmtNode(const LoomSourceLocation& loc, ExprNode* expr = nullptr)
+      : StmtNode(NodeKind::ReturnStmtNode, loc), expression(expr) {}
 
   std::string toString() const override {
     std::string result = "ReturnStmt(";
@@ -694,38 +943,44 @@ class ReturnStmtNode : public StmtNode {
     return result;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::ReturnStmtNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
-class ExprStmtNode : public StmtNode {
+class ExprStmtNode final : public StmtNode {
  public:
-  std::unique_ptr<ExprNode> expression;
-  ExprStmtNode(const LoomSourceLocation& loc, std::unique_ptr<ExprNode> expr)
-      : StmtNode(loc), expression(std::move(expr)) {}
+  ExprNode* expression;
+  ExprStmtNode(const LoomSourceLocation& loc, ExprNode* expr)
+      : StmtNode(NodeKind::ExprStmtNode, loc), expression(expr) {}
   std::string toString() const override {
     return "ExprStmt(" + (expression ? expression->toString() : "null") + ")";
   }
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::ExprStmtNode;
+  }
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // IfStmtNode for if-else statements
-class IfStmtNode : public StmtNode {
+class IfStmtNode final : public StmtNode {
  public:
-  std::unique_ptr<ExprNode> condition;
-  std::vector<std::unique_ptr<StmtNode>> then_body;
-  std::vector<std::unique_ptr<StmtNode>> else_body;  // optional
+  ExprNode* condition;
+  NodeList<StmtNode> then_body;
+  NodeList<StmtNode> else_body;  // optional
 
-  IfStmtNode(const LoomSourceLocation& loc, std::unique_ptr<ExprNode> cond,
-             std::vector<std::unique_ptr<StmtNode>> then_stmts,
-             std::vector<std::unique_ptr<StmtNode>> else_stmts = {})
-      : StmtNode(loc),
-        condition(std::move(cond)),
-        then_body(std::move(then_stmts)),
-        else_body(std::move(else_stmts)) {}
+  IfStmtNode(const LoomSourceLocation& loc, ExprNode* cond,
+             NodeList<StmtNode> then_stmts, NodeList<StmtNode> else_stmts = {})
+      : StmtNode(NodeKind::IfStmtNode, loc),
+        condition(cond),
+        then_body(then_stmts),
+        else_body(else_stmts) {}
 
   std::string toString() const override {
     std::string result =
@@ -742,19 +997,23 @@ class IfStmtNode : public StmtNode {
     return result;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::IfStmtNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
-class WhileStmtNode : public StmtNode {
+class WhileStmtNode final : public StmtNode {
  public:
-  std::unique_ptr<ExprNode> condition;
-  std::vector<std::unique_ptr<StmtNode>> body;
+  ExprNode* condition;
+  NodeList<StmtNode> body;
 
-  WhileStmtNode(const LoomSourceLocation& loc, std::unique_ptr<ExprNode> cond,
-                std::vector<std::unique_ptr<StmtNode>> stmts)
-      : StmtNode(loc), condition(std::move(cond)), body(std::move(stmts)) {}
+  WhileStmtNode(const LoomSourceLocation& loc, ExprNode* cond,
+                NodeList<StmtNode> stmts)
+      : StmtNode(NodeKind::WhileStmtNode, loc), condition(cond), body(stmts) {}
 
   std::string toString() const override {
     std::string result = "WhileStmt(cond: ";
@@ -768,41 +1027,51 @@ class WhileStmtNode : public StmtNode {
     return result;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::WhileStmtNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Defer statement: defer statement
-class DeferStmtNode : public StmtNode {
+class DeferStmtNode final : public StmtNode {
  public:
-  std::unique_ptr<StmtNode> deferred_statement;
+  StmtNode* deferred_statement;
 
-  DeferStmtNode(const LoomSourceLocation& loc, std::unique_ptr<StmtNode> stmt)
-      : StmtNode(loc), deferred_statement(std::move(stmt)) {}
+  DeferStmtNode(const LoomSourceLocation& loc, StmtNode* stmt)
+      : StmtNode(NodeKind::DeferStmtNode, loc), deferred_statement(stmt) {}
 
   std::string toString() const override {
     return "defer " +
            (deferred_statement ? deferred_statement->toString() : "null");
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::DeferStmtNode;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // FunctionCallExpr for print() calls
-class FunctionCallExpr : public ExprNode {
+class FunctionCallExpr final : public ExprNode {
  public:
-  std::string function_name;
-  std::vector<std::unique_ptr<ExprNode>> arguments;
+  Symbol function_name;
+  NodeList<ExprNode> arguments;
 
-  FunctionCallExpr(const LoomSourceLocation& loc, const std::string& name,
-                   std::vector<std::unique_ptr<ExprNode>> args)
-      : ExprNode(loc), function_name(name), arguments(std::move(args)) {}
+  FunctionCallExpr(const LoomSourceLocation& loc, Symbol name,
+                   NodeList<ExprNode> args)
+      : ExprNode(NodeKind::FunctionCallExpr, loc),
+        function_name(name),
+        arguments(args) {}
 
   std::string toString() const override {
-    std::string result = "FunctionCall(" + function_name + "(";
+    std::string result = "FunctionCall(" + function_name.str() + "(";
     for (size_t i = 0; i < arguments.size(); ++i) {
       if (i > 0) result += ", ";
       result += arguments[i] ? arguments[i]->toString() : "null";
@@ -811,23 +1080,29 @@ class FunctionCallExpr : public ExprNode {
     return result;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::FunctionCallExpr;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // BuiltinCallExpr for $$builtin() calls
-class BuiltinCallExpr : public ExprNode {
+class BuiltinCallExpr final : public ExprNode {
  public:
-  std::string builtin_name;  // e.g., "print", "exit", "syscall"
-  std::vector<std::unique_ptr<ExprNode>> arguments;
+  std::string_view builtin_name;  // e.g., "print", "exit", "syscall"
+  NodeList<ExprNode> arguments;
 
-  BuiltinCallExpr(const LoomSourceLocation& loc, const std::string& name,
-                  std::vector<std::unique_ptr<ExprNode>> args)
-      : ExprNode(loc), builtin_name(name), arguments(std::move(args)) {}
+  BuiltinCallExpr(const LoomSourceLocation& loc, std::string_view name,
+                  NodeList<ExprNode> args)
+      : ExprNode(NodeKind::BuiltinCallExpr, loc),
+        builtin_name(name),
+        arguments(args) {}
 
   std::string toString() const override {
-    std::string result = "BuiltinCall($$" + builtin_name + "(";
+    std::string result = "BuiltinCall($$" + std::string(builtin_name) + "(";
     for (size_t i = 0; i < arguments.size(); ++i) {
       if (i > 0) result += ", ";
       result += arguments[i] ? arguments[i]->toString() : "null";
@@ -836,7 +1111,11 @@ class BuiltinCallExpr : public ExprNode {
     return result;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::BuiltinCallExpr;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
@@ -844,93 +1123,109 @@ class BuiltinCallExpr : public ExprNode {
 // Memory model expression nodes
 
 // Reference expression: &expr
-class ReferenceExpr : public ExprNode {
+class ReferenceExpr final : public ExprNode {
  public:
-  std::unique_ptr<ExprNode> operand;
+  ExprNode* operand;
 
-  ReferenceExpr(const LoomSourceLocation& loc, std::unique_ptr<ExprNode> expr)
-      : ExprNode(loc), operand(std::move(expr)) {}
+  ReferenceExpr(const LoomSourceLocation& loc, ExprNode* expr)
+      : ExprNode(NodeKind::ReferenceExpr, loc), operand(expr) {}
 
   std::string toString() const override {
     return "&(" + (operand ? operand->toString() : "null") + ")";
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::ReferenceExpr;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Dereference expression: *expr or ^expr
-class DereferenceExpr : public ExprNode {
+class DereferenceExpr final : public ExprNode {
  public:
-  std::unique_ptr<ExprNode> operand;
+  ExprNode* operand;
   TokenType deref_type;  // TOKEN_STAR for *, TOKEN_HAT for ^
 
-  DereferenceExpr(const LoomSourceLocation& loc, std::unique_ptr<ExprNode> expr,
-                  TokenType type)
-      : ExprNode(loc), operand(std::move(expr)), deref_type(type) {}
+  DereferenceExpr(const LoomSourceLocation& loc, ExprNode* expr, TokenType type)
+      : ExprNode(NodeKind::DereferenceExpr, loc),
+        operand(expr),
+        deref_type(type) {}
 
   std::string toString() const override {
     std::string op = (deref_type == TokenType::TOKEN_STAR) ? "*" : "^";
     return op + "(" + (operand ? operand->toString() : "null") + ")";
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::DereferenceExpr;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Member access expression: expr.field
-class MemberAccessExpr : public ExprNode {
+class MemberAccessExpr final : public ExprNode {
  public:
-  std::unique_ptr<ExprNode> object;
-  std::string member_name;
+  ExprNode* object;
+  Symbol member_name;
 
-  MemberAccessExpr(const LoomSourceLocation& loc, std::unique_ptr<ExprNode> obj,
-                   const std::string& member)
-      : ExprNode(loc), object(std::move(obj)), member_name(member) {}
+  MemberAccessExpr(const LoomSourceLocation& loc, ExprNode* obj, Symbol member)
+      : ExprNode(NodeKind::MemberAccessExpr, loc),
+        object(obj),
+        member_name(member) {}
 
   std::string toString() const override {
-    return (object ? object->toString() : "null") + "." + member_name;
+    return (object ? object->toString() : "null") + "." + member_name.str();
+  }
+
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::MemberAccessExpr;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Pointer access expression: expr->field
-class PointerAccessExpr : public ExprNode {
+class PointerAccessExpr final : public ExprNode {
  public:
-  std::unique_ptr<ExprNode> pointer;
-  std::string member_name;
+  ExprNode* pointer;
+  Symbol member_name;
 
-  PointerAccessExpr(const LoomSourceLocation& loc,
-                    std::unique_ptr<ExprNode> ptr, const std::string& member)
-      : ExprNode(loc), pointer(std::move(ptr)), member_name(member) {}
+  PointerAccessExpr(const LoomSourceLocation& loc, ExprNode* ptr, Symbol member)
+      : ExprNode(NodeKind::PointerAccessExpr, loc),
+        pointer(ptr),
+        member_name(member) {}
 
   std::string toString() const override {
-    return (pointer ? pointer->toString() : "null") + "->" + member_name;
+    return (pointer ? pointer->toString() : "null") + "->" + member_name.str();
+  }
+
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::PointerAccessExpr;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Slice expression: expr[start..end]
-class SliceExpr : public ExprNode {
+class SliceExpr final : public ExprNode {
  public:
-  std::unique_ptr<ExprNode> array;
-  std::unique_ptr<ExprNode> start;
-  std::unique_ptr<ExprNode> end;
+  ExprNode* array;
+  ExprNode* start;
+  ExprNode* end;
 
-  SliceExpr(const LoomSourceLocation& loc, std::unique_ptr<ExprNode> arr,
-            std::unique_ptr<ExprNode> s, std::unique_ptr<ExprNode> e)
-      : ExprNode(loc),
-        array(std::move(arr)),
-        start(std::move(s)),
-        end(std::move(e)) {}
+  SliceExpr(const LoomSourceLocation& loc, ExprNode* arr, ExprNode* s,
+            ExprNode* e)
+      : ExprNode(NodeKind::SliceExpr, loc), array(arr), start(s), end(e) {}
 
   std::string toString() const override {
     return (array ? array->toString() : "null") + "[" +
@@ -938,19 +1233,22 @@ class SliceExpr : public ExprNode {
            (end ? end->toString() : "") + "]";
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::SliceExpr;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
 
 // Unsafe block expression: unsafe { ... }
-class UnsafeBlockExpr : public ExprNode {
+class UnsafeBlockExpr final : public ExprNode {
  public:
-  std::vector<std::unique_ptr<StmtNode>> statements;
+  NodeList<StmtNode> statements;
 
-  UnsafeBlockExpr(const LoomSourceLocation& loc,
-                  std::vector<std::unique_ptr<StmtNode>> stmts)
-      : ExprNode(loc), statements(std::move(stmts)) {}
+  UnsafeBlockExpr(const LoomSourceLocation& loc, NodeList<StmtNode> stmts)
+      : ExprNode(NodeKind::UnsafeBlockExpr, loc), statements(stmts) {}
 
   std::string toString() const override {
     std::string result = "unsafe { ";
@@ -962,7 +1260,11 @@ class UnsafeBlockExpr : public ExprNode {
     return result;
   }
 
-  std::unique_ptr<TypeNode> accept(ASTVisitor& visitor) override {
+  static bool classof(const ASTNode* node) {
+    return node->getKind() == NodeKind::UnsafeBlockExpr;
+  }
+
+  TypeNode* accept(ASTVisitor& visitor) override {
     return visitor.visit(*this);
   }
 };
\ No newline at end of file
@@ -7,7 +7,7 @@ void ASTPrinter::indent() {
   }
 }
 
-void ASTPrinter::print(const std::vector<std::unique_ptr<StmtNode>>& ast) {
+void ASTPrinter::print(const std::vector<StmtNode*>& ast) {
   indent();
   std::cout << "- Program" << std::endl;
   indentation_level++;
@@ -19,7 +19,7 @@ void ASTPrinter::print(const std::vector<std::unique_ptr<StmtNode>>& ast) {
   indentation_level--;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(VarDeclNode& node) {
+TypeNode* ASTPrinter::visit(VarDeclNode& node) {
   indent();
   std::string kind_str;
   switch (node.kind) {
@@ -47,7 +47,7 @@ std::unique_ptr<TypeNode> ASTPrinter::visit(VarDeclNode& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(ExprStmtNode& node) {
+TypeNode* ASTPrinter::visit(ExprStmtNode& node) {
   indent();
   std::cout << "- ExprStmt:" << std::endl;
   indentation_level++;
@@ -58,7 +58,7 @@ std::unique_ptr<TypeNode> ASTPrinter::visit(ExprStmtNode& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(AssignmentExpr& node) {
+TypeNode* ASTPrinter::visit(AssignmentExpr& node) {
   indent();
   std::cout << "- Assignment(" << node.name << "):" << std::endl;
   if (node.value) {
@@ -72,9 +72,9 @@ std::unique_ptr<TypeNode> ASTPrinter::visit(AssignmentExpr& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(BinaryExpr& node) {
+TypeNode* ASTPrinter::visit(BinaryExpr& node) {
   indent();
-  std::cout << "- Binary(" << node.op.value << ")" << std::endl;
+  std::cout << "- Binary(" << operatorSpelling(node.op) << ")" << std::endl;
   indentation_level++;
   if (node.left) {
     indent();
@@ -90,9 +90,9 @@ std::unique_ptr<TypeNode> ASTPrinter::visit(BinaryExpr& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(UnaryExpr& node) {
+TypeNode* ASTPrinter::visit(UnaryExpr& node) {
   indent();
-  std::cout << "- Unary(" << node.op.value << ")" << std::endl;
+  std::cout << "- Unary(" << operatorSpelling(node.op) << ")" << std::endl;
   indentation_level++;
   if (node.right) {
     indent();
@@ -103,65 +103,65 @@ std::unique_ptr<TypeNode> ASTPrinter::visit(UnaryExpr& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(NumberLiteral& node) {
+TypeNode* ASTPrinter::visit(NumberLiteral& node) {
   indent();
   std::cout << "- " << node.toString() << std::endl;
   return nullptr;
 }
-std::unique_ptr<TypeNode> ASTPrinter::visit(Identifier& node) {
+TypeNode* ASTPrinter::visit(Identifier& node) {
   indent();
   std::cout << "- " << node.toString() << std::endl;
   return nullptr;
 }
-std::unique_ptr<TypeNode> ASTPrinter::visit(StringLiteral& node) {
+TypeNode* ASTPrinter::visit(StringLiteral& node) {
   indent();
   std::cout << "- " << node.toString() << std::endl;
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(TypeNode& node) {
+TypeNode* ASTPrinter::visit(TypeNode& node) {
   indent();
   std::cout << "- " << node.toString() << std::endl;
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(BooleanLiteral& node) {
+TypeNode* ASTPrinter::visit(BooleanLiteral& node) {
   indent();
   std::cout << "- " << node.toString() << std::endl;
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(IntegerTypeNode& node) {
+TypeNode* ASTPrinter::visit(IntegerTypeNode& node) {
   indent();
   std::cout << "- " << node.toString() << std::endl;
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(FloatTypeNode& node) {
+TypeNode* ASTPrinter::visit(FloatTypeNode& node) {
   indent();
   std::cout << "- " << node.toString() << std::endl;
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(BooleanTypeNode& node) {
+TypeNode* ASTPrinter::visit(BooleanTypeNode& node) {
   indent();
   std::cout << "- " << node.toString() << std::endl;
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(StringTypeNode& node) {
+TypeNode* ASTPrinter::visit(StringTypeNode& node) {
   indent();
   std::cout << "- " << node.toString() << std::endl;
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(IntegerLiteralTypeNode& node) {
+TypeNode* ASTPrinter::visit(IntegerLiteralTypeNode& node) {
   indent();
   std::cout << "- " << node.toString() << std::endl;
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> ASTPrinter::visit(FloatLiteralTypeNode& node) {
+TypeNode* ASTPrinter::visit(FloatLiteralTypeNode& node) {
   indent();
   std::cout << "- " << node.toString() << std::endl;
   return nullptr;
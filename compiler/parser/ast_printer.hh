@@ -2,29 +2,30 @@
 #pragma once
 
 #include <iostream>
+#include <vector>
 
 #include "parser/ast.hh"
 
 class ASTPrinter : public ASTVisitor {
  public:
-  void print(const std::vector<std::unique_ptr<StmtNode>>& ast);
-  std::unique_ptr<TypeNode> visit(NumberLiteral& node) override;
-  std::unique_ptr<TypeNode> visit(Identifier& node) override;
-  std::unique_ptr<TypeNode> visit(StringLiteral& node) override;
-  std::unique_ptr<TypeNode> visit(BooleanLiteral& node) override;
+  void print(const std::vector<StmtNode*>& ast);
+  TypeNode* visit(NumberLiteral& node) override;
+  TypeNode* visit(Identifier& node) override;
+  TypeNode* visit(StringLiteral& node) override;
+  TypeNode* visit(BooleanLiteral& node) override;
 
-  std::unique_ptr<TypeNode> visit(AssignmentExpr& node) override;
-  std::unique_ptr<TypeNode> visit(BinaryExpr& node) override;
-  std::unique_ptr<TypeNode> visit(VarDeclNode& node) override;
-  std::unique_ptr<TypeNode> visit(ExprStmtNode& node) override;
-  std::unique_ptr<TypeNode> visit(UnaryExpr& node) override;
-  std::unique_ptr<TypeNode> visit(TypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(IntegerTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(FloatTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(BooleanTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(StringTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(IntegerLiteralTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(FloatLiteralTypeNode& node) override;
+  TypeNode* visit(AssignmentExpr& node) override;
+  TypeNode* visit(BinaryExpr& node) override;
+  TypeNode* visit(VarDeclNode& node) override;
+  TypeNode* visit(ExprStmtNode& node) override;
+  TypeNode* visit(UnaryExpr& node) override;
+  TypeNode* visit(TypeNode& node) override;
+  TypeNode* visit(IntegerTypeNode& node) override;
+  TypeNode* visit(FloatTypeNode& node) override;
+  TypeNode* visit(BooleanTypeNode& node) override;
+  TypeNode* visit(StringTypeNode& node) override;
+  TypeNode* visit(IntegerLiteralTypeNode& node) override;
+  TypeNode* visit(FloatLiteralTypeNode& node) override;
 
  private:
   void indent();
@@ -1,20 +1,38 @@
 // parser.cc
+#include <algorithm>
+#include <future>
 #include <iostream>
+#include <sstream>
 
+#include "../common/thread_pool.hh"
+#include "../common/time_report.hh"
 #include "parser_internal.hh"
 
-Parser::Parser(const std::vector<LoomToken>& tokens)
-    : tokens(tokens), had_error(false) {}
+Parser::Parser(TokenStream& tokens, const LoomSourceFile& file, Arena& arena,
+               std::ostream& diagnostics)
+    : tokens(tokens),
+      file(file),
+      arena(arena),
+      had_error(false),
+      diagnostics(diagnostics) {}
 
 bool Parser::isAtEnd() const { return peek().type == TokenType::TOKEN_EOF; }
 
-const LoomToken& Parser::peek() const { return tokens[current]; }
+const LoomToken& Parser::peek() const { return tokens.peek(); }
 
-const LoomToken& Parser::previous() const { return tokens[current - 1]; }
+const LoomToken& Parser::previous() const { return previous_token; }
+
+std::string_view Parser::textOf(const LoomToken& token) const {
+  return token.text(file.getText());
+}
+
+LoomSourceLocation Parser::locationOf(const LoomToken& token) const {
+  return LoomSourceLocation{file.getStartLocation() + token.offset};
+}
 
 void Parser::advance() {
   if (!isAtEnd()) {
-    current++;
+    previous_token = tokens.next();
   }
 }
 
@@ -41,9 +59,12 @@ void Parser::consume(TokenType type, const std::string& message) {
 
 void Parser::error(const LoomToken& token, const std::string& message) {
   had_error = true;
-  std::cerr << "Parse error at " << token.location.toString() << ": " << message
-            << std::endl;
-  throw ParseError(message);
+  // A malformed token is the real cause; report the scanner's message
+  const std::string reported =
+      token.type == TokenType::TOKEN_ERROR ? scanErrorMessage(token) : message;
+  diagnostics << "Parse error at " << file.describe(token.offset) << ": "
+              << reported << std::endl;
+  throw ParseError(reported);
 }
 
 void Parser::synchronize() {
@@ -63,8 +84,8 @@ void Parser::synchronize() {
 }
 
 // Die Haupt-parse()-Schleife gehört auch hierher.
-std::vector<std::unique_ptr<StmtNode>> Parser::parse() {
-  std::vector<std::unique_ptr<StmtNode>> statements;
+std::vector<StmtNode*> Parser::parse() {
+  std::vector<StmtNode*> statements;
   while (!isAtEnd()) {
     if (match(TokenType::TOKEN_NEWLINE)) {
       continue;
@@ -72,8 +93,150 @@ std::vector<std::unique_ptr<StmtNode>> Parser::parse() {
 
     auto decl = parseDeclaration();
     if (decl) {
-      statements.push_back(std::move(decl));
+      statements.push_back(decl);
     }
   }
   return statements;
-}
\ No newline at end of file
+}
+bool parseSkippedBody(FunctionDeclNode& func, const LoomSourceFile& file,
+                      Arena& arena, std::ostream& diagnostics) {
+  // Scan only the body: the scanner stops after its '}', so error recovery
+  // can't run into the declarations after it
+  const uint32_t begin = func.body_begin.offset - file.getStartLocation();
+  Scanner scanner(file.getText().substr(0, begin + func.body_length),
+                  file.getFilename());
+  scanner.seek(begin);
+  TokenStream tokens(scanner);
+  Parser parser(tokens, file, arena, diagnostics);
+  try {
+    parser.parseFunctionBody(func);
+  } catch (const ParseError&) {
+    // Already reported
+  }
+  return !parser.hasError();
+}
+
+// Ranges smaller than this aren't worth a task of their own
+static constexpr size_t kMinRangeTokens = size_t{1} << 14;
+
+std::vector<size_t> findDeclarationBoundaries(
+    std::span<const LoomToken> tokens, size_t range_size) {
+  std::vector<size_t> boundaries{0};
+  size_t next_cut = range_size;
+  size_t depth = 0;
+  // Last token before i that isn't a newline
+  TokenType last = TokenType::TOKEN_SEMICOLON;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    const TokenType type = tokens[i].type;
+    switch (type) {
+      case TokenType::TOKEN_LEFT_BRACE:
+        ++depth;
+        break;
+      case TokenType::TOKEN_RIGHT_BRACE:
+        // A stray '}' leaves the parser stuck; don't guess past it
+        if (depth == 0) return boundaries;
+        --depth;
+        break;
+      case TokenType::TOKEN_KEYWORD_FUNC:
+      case TokenType::TOKEN_KEYWORD_LET:
+      case TokenType::TOKEN_KEYWORD_MUT:
+      case TokenType::TOKEN_KEYWORD_DEFINE:
+        if (i >= next_cut && depth == 0 &&
+            (last == TokenType::TOKEN_SEMICOLON ||
+             last == TokenType::TOKEN_RIGHT_BRACE)) {
+          boundaries.push_back(i);
+          next_cut = i + range_size;
+        }
+        break;
+      case TokenType::TOKEN_NEWLINE:
+        continue;
+      default:
+        break;
+    }
+    last = type;
+  }
+  return boundaries;
+}
+
+ParallelParseResult parseParallel(std::span<const LoomToken> tokens,
+                                  const LoomSourceFile& file,
+                                  std::ostream& diagnostics,
+                                  bool lazy_function_bodies,
+                                  unsigned thread_count) {
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  // A few ranges per thread even out declarations of very different size
+  size_t range_size =
+      std::max(kMinRangeTokens, tokens.size() / (size_t{thread_count} * 4));
+  std::vector<size_t> boundaries =
+      findDeclarationBoundaries(tokens, range_size);
+  boundaries.push_back(tokens.size());
+  const size_t range_count = boundaries.size() - 1;
+
+  ParallelParseResult result;
+  auto parse_all = [&]() {
+    result.arenas.push_back(std::make_unique<Arena>());
+    TokenStream stream(tokens);
+    Parser parser(stream, file, *result.arenas.back(), diagnostics);
+    parser.setLazyFunctionBodies(lazy_function_bodies);
+    result.statements = parser.parse();
+    result.had_error = parser.hasError();
+  };
+  if (range_count == 1) {
+    parse_all();
+    return result;
+  }
+
+  struct Range {
+    std::unique_ptr<Arena> arena = std::make_unique<Arena>();
+    std::vector<StmtNode*> statements;
+    bool had_error = false;
+  };
+  std::vector<Range> ranges(range_count);
+  {
+    ThreadPool pool(static_cast<unsigned>(
+        std::min<size_t>(range_count, thread_count)));
+    std::vector<std::future<void>> jobs;
+    jobs.reserve(range_count);
+    // The workers' CPU time belongs to the caller's phase
+    TimeReport::Scope* phase = TimeReport::Scope::current();
+    for (size_t i = 0; i < range_count; ++i) {
+      jobs.push_back(pool.submit([&, i]() {
+        TimeReport::WorkerCPU worker_cpu(phase);
+        TokenStream stream(
+            tokens.subspan(boundaries[i], boundaries[i + 1] - boundaries[i]));
+        // Errors are reported by the serial parse below
+        std::ostringstream discarded;
+        Parser parser(stream, file, *ranges[i].arena, discarded);
+        parser.setLazyFunctionBodies(lazy_function_bodies);
+        ranges[i].statements = parser.parse();
+        ranges[i].had_error = parser.hasError();
+      }));
+    }
+    for (auto& job : jobs) {
+      job.get();
+    }
+  }
+
+  // Error recovery may skip across a boundary, so the ranges of a broken
+  // file don't add up to the serial parse
+  if (std::any_of(ranges.begin(), ranges.end(),
+                  [](const Range& range) { return range.had_error; })) {
+    parse_all();
+    return result;
+  }
+
+  size_t total = 0;
+  for (const auto& range : ranges) {
+    total += range.statements.size();
+  }
+  result.statements.reserve(total);
+  for (auto& range : ranges) {
+    result.statements.insert(result.statements.end(),
+                             range.statements.begin(),
+                             range.statements.end());
+    result.arenas.push_back(std::move(range.arena));
+  }
+  return result;
+}
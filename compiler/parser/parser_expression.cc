@@ -1,141 +1,165 @@
 // parser_expression.cc
+#include <array>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 
 #include "parser_internal.hh"
 
-std::unique_ptr<ExprNode> Parser::parseExpression() {
-  return parseAssignment();
+// How tightly a binary operator binds; higher binds tighter
+enum Precedence : uint8_t {
+  PREC_NONE,        // not a binary operator
+  PREC_EQUALITY,    // ==
+  PREC_COMPARISON,  // < > <= >=
+  PREC_TERM,        // + -
+  PREC_FACTOR,      // * /
+};
+
+// The binary operators, all left-associative. Adding one only takes an
+// entry here (and its handling in sema and codegen); the lookup table below
+// is derived from this list at compile time.
+struct BinaryOperator {
+  TokenType type;
+  Precedence precedence;
+};
+
+static constexpr BinaryOperator binary_operators[] = {
+    {TokenType::TOKEN_EQUAL_EQUAL, PREC_EQUALITY},
+    {TokenType::TOKEN_LESS, PREC_COMPARISON},
+    {TokenType::TOKEN_GREATER, PREC_COMPARISON},
+    {TokenType::TOKEN_LESS_EQUAL, PREC_COMPARISON},
+    {TokenType::TOKEN_GREATER_EQUAL, PREC_COMPARISON},
+    {TokenType::TOKEN_PLUS, PREC_TERM},
+    {TokenType::TOKEN_MINUS, PREC_TERM},
+    {TokenType::TOKEN_STAR, PREC_FACTOR},
+    {TokenType::TOKEN_SLASH, PREC_FACTOR},
+};
+
+// Precedence of every token type, PREC_NONE for all but the operators.
+// TOKEN_ERROR is the last token type.
+using PrecedenceTable =
+    std::array<Precedence, static_cast<size_t>(TokenType::TOKEN_ERROR) + 1>;
+
+static constexpr PrecedenceTable buildPrecedenceTable() {
+  PrecedenceTable table{};
+  for (const BinaryOperator& op : binary_operators) {
+    table[static_cast<size_t>(op.type)] = op.precedence;
+  }
+  return table;
 }
 
-std::unique_ptr<ExprNode> Parser::parseAssignment() {
-  std::unique_ptr<ExprNode> expr = parseEquality();
-
-  if (match(TokenType::TOKEN_EQUAL)) {
-    const LoomToken& equals = previous();
-    std::unique_ptr<ExprNode> value = parseAssignment();
-
-    if (Identifier* target = dynamic_cast<Identifier*>(expr.get())) {
-      return std::make_unique<AssignmentExpr>(target->location, target->name,
-                                              std::move(value));
-    }
-
-    error(equals, "Invalid assignment target.");
-    return nullptr;
-  }
+static constexpr PrecedenceTable precedence_table = buildPrecedenceTable();
 
-  return expr;
+static Precedence binaryPrecedence(TokenType type) {
+  return precedence_table[static_cast<size_t>(type)];
 }
 
-std::unique_ptr<ExprNode> Parser::parseEquality() {
-  std::unique_ptr<ExprNode> expr = parseComparison();
-
-  while (match(TokenType::TOKEN_EQUAL_EQUAL)) {
-    const LoomToken& op = previous();
-    std::unique_ptr<ExprNode> right = parseTerm();
-    expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-  }
+ExprNode* Parser::parseExpression() { return parseAssignment(); }
 
-  return expr;
-}
+ExprNode* Parser::parseAssignment() {
+  ExprNode* expr = parseBinary(PREC_NONE);
 
-std::unique_ptr<ExprNode> Parser::parseComparison() {
-  std::unique_ptr<ExprNode> expr = parseTerm();
-  while (match(TokenType::TOKEN_LESS) || match(TokenType::TOKEN_GREATER) ||
-         match(TokenType::TOKEN_LESS_EQUAL) ||
-         match(TokenType::TOKEN_GREATER_EQUAL)) {
-    const LoomToken& op = previous();
-    std::unique_ptr<ExprNode> right = parseTerm();
-    expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-  }
-  return expr;
-}
+  if (match(TokenType::TOKEN_EQUAL)) {
+    const LoomToken equals = previous();
+    ExprNode* value = parseAssignment();
 
-std::unique_ptr<ExprNode> Parser::parseTerm() {
-  std::unique_ptr<ExprNode> expr = parseFactor();
+    if (Identifier* target = dyn_cast<Identifier>(expr)) {
+      return arena.create<AssignmentExpr>(target->location, target->name,
+                                          value);
+    }
 
-  while (match(TokenType::TOKEN_PLUS) || match(TokenType::TOKEN_MINUS)) {
-    const LoomToken& op = previous();
-    std::unique_ptr<ExprNode> right = parseFactor();  // Parse den rechten Teil
-    expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+    error(equals, "Invalid assignment target.");
+    return nullptr;
   }
 
   return expr;
 }
 
-std::unique_ptr<ExprNode> Parser::parseFactor() {
-  std::unique_ptr<ExprNode> expr = parseUnary();
+// Precedence climbing: parses operands and every binary operator that
+// binds tighter than min_precedence in one loop. An operator's right
+// operand only takes operators binding tighter than it, which makes them
+// left-associative.
+ExprNode* Parser::parseBinary(int min_precedence) {
+  ExprNode* expr = parseUnary();
 
-  while (match(TokenType::TOKEN_STAR) || match(TokenType::TOKEN_SLASH)) {
-    const LoomToken& op = previous();
-    std::unique_ptr<ExprNode> right = parseUnary();
-    expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+  while (true) {
+    const Precedence precedence = binaryPrecedence(peek().type);
+    if (precedence <= min_precedence) break;
+    advance();
+    const LoomToken op = previous();
+    ExprNode* right = parseBinary(precedence);
+    expr = arena.create<BinaryExpr>(expr, op.type, locationOf(op), right);
   }
 
   return expr;
 }
 
-std::unique_ptr<ExprNode> Parser::parseUnary() {
-  // Handle memory model unary operators
-  if (match(TokenType::TOKEN_AMPERSAND)) {
-    // Reference operator: &expr
-    const LoomToken& op = previous();
-    std::unique_ptr<ExprNode> right = parseUnary();
-    return std::make_unique<ReferenceExpr>(op.location, std::move(right));
-  }
-
-  if (match(TokenType::TOKEN_STAR) || match(TokenType::TOKEN_HAT)) {
-    // Dereference operators: *expr or ^expr
-    const LoomToken& op = previous();
-    std::unique_ptr<ExprNode> right = parseUnary();
-    return std::make_unique<DereferenceExpr>(op.location, std::move(right),
-                                             op.type);
-  }
-
-  // Handle traditional unary operators
-  if (match(TokenType::TOKEN_MINUS) || match(TokenType::TOKEN_BANG)) {
-    const LoomToken& op = previous();
-    std::unique_ptr<ExprNode> right = parseUnary();
-    return std::make_unique<UnaryExpr>(op, std::move(right));
+ExprNode* Parser::parseUnary() {
+  // One look at the token instead of a match() per operator
+  switch (peek().type) {
+    case TokenType::TOKEN_AMPERSAND: {
+      // Reference operator: &expr
+      advance();
+      const LoomToken op = previous();
+      ExprNode* right = parseUnary();
+      return arena.create<ReferenceExpr>(locationOf(op), right);
+    }
+    case TokenType::TOKEN_STAR:
+    case TokenType::TOKEN_HAT: {
+      // Dereference operators: *expr or ^expr
+      advance();
+      const LoomToken op = previous();
+      ExprNode* right = parseUnary();
+      return arena.create<DereferenceExpr>(locationOf(op), right, op.type);
+    }
+    case TokenType::TOKEN_MINUS:
+    case TokenType::TOKEN_BANG: {
+      // Handle traditional unary operators
+      advance();
+      const LoomToken op = previous();
+      ExprNode* right = parseUnary();
+      return arena.create<UnaryExpr>(locationOf(op), op.type, right);
+    }
+    default:
+      return parseCall();
   }
-
-  return parseCall();
 }
 
-std::unique_ptr<ExprNode> Parser::parsePrimary() {
+ExprNode* Parser::parsePrimary() {
   if (match(TokenType::TOKEN_NUMBER_INT)) {
-    const LoomToken& token = previous();
-    return std::make_unique<NumberLiteral>(token.location, token.value, false);
+    const LoomToken token = previous();
+    return arena.create<NumberLiteral>(locationOf(token), token.int_value);
   }
   if (match(TokenType::TOKEN_NUMBER_FLOAT)) {
-    const LoomToken& token = previous();
-    return std::make_unique<NumberLiteral>(token.location, token.value, true);
+    const LoomToken token = previous();
+    return arena.create<NumberLiteral>(locationOf(token), token.float_value);
   }
   if (match(TokenType::TOKEN_IDENTIFIER)) {
-    const LoomToken& token = previous();
-    return std::make_unique<Identifier>(token.location, token.value);
+    const LoomToken token = previous();
+    return arena.create<Identifier>(locationOf(token), token.symbol);
   }
   if (match(TokenType::TOKEN_BUILTIN)) {
     return parseBuiltinCall();
   }
   if (match(TokenType::TOKEN_STRING)) {
-    const LoomToken& token = previous();
-    return std::make_unique<StringLiteral>(token.location, token.value);
+    const LoomToken token = previous();
+    return arena.create<StringLiteral>(locationOf(token), textOf(token));
   }
   if (match(TokenType::TOKEN_KEYWORD_TRUE)) {
-    return std::make_unique<BooleanLiteral>(previous().location, true);
+    return arena.create<BooleanLiteral>(locationOf(previous()), true);
   }
   if (match(TokenType::TOKEN_KEYWORD_FALSE)) {
-    return std::make_unique<BooleanLiteral>(previous().location, false);
+    return arena.create<BooleanLiteral>(locationOf(previous()), false);
   }
   if (match(TokenType::TOKEN_KEYWORD_NULL)) {
-    const LoomToken& token = previous();
-    return std::make_unique<Identifier>(
-        token.location, "null");  // For now, treat as identifier
+    const LoomToken token = previous();
+    return arena.create<Identifier>(
+        locationOf(token),
+        Symbol::intern("null"));  // For now, treat as identifier
   }
 
   if (match(TokenType::TOKEN_LEFT_PAREN)) {
-    std::unique_ptr<ExprNode> expr = parseExpression();
+    ExprNode* expr = parseExpression();
     consume(TokenType::TOKEN_RIGHT_PAREN, "Exprected ')' after expression.");
 
     // TODO: GroupingExpr-Node ?
@@ -146,36 +170,37 @@ std::unique_ptr<ExprNode> Parser::parsePrimary() {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> Parser::parseType() {
+TypeNode* Parser::parseType() {
   // Handle memory model prefix types: &T, ^T, []T
   if (match(TokenType::TOKEN_AMPERSAND)) {
     // Reference type: &T
-    LoomSourceLocation loc = previous().location;
+    LoomSourceLocation loc = locationOf(previous());
     auto inner_type = parseType();
-    return std::make_unique<ReferenceTypeNode>(loc, std::move(inner_type));
+    return arena.create<ReferenceTypeNode>(loc, inner_type);
   }
 
   if (match(TokenType::TOKEN_HAT)) {
     // Owned pointer type: ^T
-    LoomSourceLocation loc = previous().location;
+    LoomSourceLocation loc = locationOf(previous());
     auto inner_type = parseType();
-    return std::make_unique<OwnedPointerTypeNode>(loc, std::move(inner_type));
+    return arena.create<OwnedPointerTypeNode>(loc, inner_type);
   }
 
   if (match(TokenType::TOKEN_LEFT_BRACKET)) {
     // Slice type: []T
-    LoomSourceLocation loc = previous().location;
+    LoomSourceLocation loc = locationOf(previous());
     consume(TokenType::TOKEN_RIGHT_BRACKET, "Expected ']' after '['");
     auto element_type = parseType();
-    return std::make_unique<SliceTypeNode>(loc, std::move(element_type));
+    return arena.create<SliceTypeNode>(loc, element_type);
   }
 
   // Parse base type
-  const LoomToken& type_token = peek();
+  const LoomToken type_token = peek();
   consume(TokenType::TOKEN_IDENTIFIER, "Expected type name.");
 
-  std::string type_name = type_token.value;
-  std::unique_ptr<TypeNode> base_type;
+  std::string type_name(textOf(type_token));
+  LoomSourceLocation type_loc = locationOf(type_token);
+  TypeNode* base_type = nullptr;
 
   // Parse integer types (i8, i16, i32, i64, u8, u16, u32, u64)
   if (type_name.length() >= 2) {
@@ -188,8 +213,8 @@ std::unique_ptr<TypeNode> Parser::parseType() {
         if (bit_width == 8 || bit_width == 16 || bit_width == 32 ||
             bit_width == 64) {
           bool is_signed = (first_char == 'i');
-          base_type = std::make_unique<IntegerTypeNode>(type_token.location,
-                                                        bit_width, is_signed);
+          base_type =
+              arena.create<IntegerTypeNode>(type_loc, bit_width, is_signed);
         }
       } catch (const std::exception&) {
         // Fall through to handle as a regular type
@@ -202,8 +227,7 @@ std::unique_ptr<TypeNode> Parser::parseType() {
         int bit_width = std::stoi(bit_width_str);
         // Validate common float bit widths
         if (bit_width == 16 || bit_width == 32 || bit_width == 64) {
-          base_type =
-              std::make_unique<FloatTypeNode>(type_token.location, bit_width);
+          base_type = arena.create<FloatTypeNode>(type_loc, bit_width);
         }
       } catch (const std::exception&) {
         // Fall through to handle as a regular type
@@ -214,9 +238,9 @@ std::unique_ptr<TypeNode> Parser::parseType() {
   // Handle special types if base_type wasn't set
   if (!base_type) {
     if (type_name == "bool") {
-      base_type = std::make_unique<BooleanTypeNode>(type_token.location);
+      base_type = arena.create<BooleanTypeNode>(type_loc);
     } else if (type_name == "string") {
-      base_type = std::make_unique<StringTypeNode>(type_token.location);
+      base_type = arena.create<StringTypeNode>(type_loc);
     } else {
       // For now, treat unknown types as generic TypeNodes
       // In a real compiler, this would be an error
@@ -226,58 +250,55 @@ std::unique_ptr<TypeNode> Parser::parseType() {
 
   // Handle nullable suffix: T?
   if (match(TokenType::TOKEN_QUESTION)) {
-    LoomSourceLocation loc = previous().location;
-    return std::make_unique<NullableTypeNode>(loc, std::move(base_type));
+    LoomSourceLocation loc = locationOf(previous());
+    return arena.create<NullableTypeNode>(loc, base_type);
   }
 
   return base_type;
 }
 
-std::unique_ptr<ExprNode> Parser::parseCall() {
-  std::unique_ptr<ExprNode> expr = parsePrimary();
+ExprNode* Parser::parseCall() {
+  ExprNode* expr = parsePrimary();
 
   while (true) {
     if (match(TokenType::TOKEN_LEFT_PAREN)) {
-      expr = finishCall(std::move(expr));
+      expr = finishCall(expr);
     } else if (match(TokenType::TOKEN_DOT)) {
       // Member access: expr.field
-      const LoomToken& dot = previous();
+      const LoomToken dot = previous();
       consume(TokenType::TOKEN_IDENTIFIER, "Expected field name after '.'");
-      const LoomToken& field = previous();
-      expr = std::make_unique<MemberAccessExpr>(dot.location, std::move(expr),
-                                                field.value);
+      const LoomToken field = previous();
+      expr =
+          arena.create<MemberAccessExpr>(locationOf(dot), expr, field.symbol);
     } else if (match(TokenType::TOKEN_ARROW)) {
       // Pointer access: expr->field
-      const LoomToken& arrow = previous();
+      const LoomToken arrow = previous();
       consume(TokenType::TOKEN_IDENTIFIER, "Expected field name after '->'");
-      const LoomToken& field = previous();
-      expr = std::make_unique<PointerAccessExpr>(arrow.location,
-                                                 std::move(expr), field.value);
+      const LoomToken field = previous();
+      expr = arena.create<PointerAccessExpr>(locationOf(arrow), expr,
+                                             field.symbol);
     } else if (match(TokenType::TOKEN_LEFT_BRACKET)) {
       // Array indexing or slice: expr[index] or expr[start..end]
-      const LoomToken& bracket = previous();
-      std::unique_ptr<ExprNode> start = parseExpression();
+      const LoomToken bracket = previous();
+      ExprNode* start = parseExpression();
 
       if (match(TokenType::TOKEN_DOT_DOT)) {
         // Slice expression: expr[start..end]
-        std::unique_ptr<ExprNode> end = nullptr;
+        ExprNode* end = nullptr;
         if (!check(TokenType::TOKEN_RIGHT_BRACKET)) {
           end = parseExpression();
         }
         consume(TokenType::TOKEN_RIGHT_BRACKET,
                 "Expected ']' after slice expression");
-        expr = std::make_unique<SliceExpr>(bracket.location, std::move(expr),
-                                           std::move(start), std::move(end));
+        expr = arena.create<SliceExpr>(locationOf(bracket), expr, start, end);
       } else {
         // Array indexing: expr[index] - TODO: implement ArrayIndexExpr
         consume(TokenType::TOKEN_RIGHT_BRACKET,
                 "Expected ']' after array index");
         // For now, treat single index as slice with same start and end
-        auto end_copy = std::unique_ptr<ExprNode>(
-            nullptr);  // TODO: clone start for single index
+        ExprNode* end_copy = nullptr;  // TODO: clone start for single index
         expr =
-            std::make_unique<SliceExpr>(bracket.location, std::move(expr),
-                                        std::move(start), std::move(end_copy));
+            arena.create<SliceExpr>(locationOf(bracket), expr, start, end_copy);
       }
     } else {
       break;
@@ -287,8 +308,8 @@ std::unique_ptr<ExprNode> Parser::parseCall() {
   return expr;
 }
 
-std::unique_ptr<ExprNode> Parser::finishCall(std::unique_ptr<ExprNode> callee) {
-  std::vector<std::unique_ptr<ExprNode>> arguments;
+ExprNode* Parser::finishCall(ExprNode* callee) {
+  std::vector<ExprNode*> arguments;
 
   if (!check(TokenType::TOKEN_RIGHT_PAREN)) {
     do {
@@ -299,26 +320,26 @@ std::unique_ptr<ExprNode> Parser::finishCall(std::unique_ptr<ExprNode> callee) {
   consume(TokenType::TOKEN_RIGHT_PAREN, "Expected ')' after arguments.");
 
   // Check if this is a function call (identifier followed by parentheses)
-  if (auto* identifier = dynamic_cast<Identifier*>(callee.get())) {
-    return std::make_unique<FunctionCallExpr>(
-        identifier->location, identifier->name, std::move(arguments));
+  if (auto* identifier = dyn_cast<Identifier>(callee)) {
+    return arena.create<FunctionCallExpr>(
+        identifier->location, identifier->name, arena.copy(arguments));
   }
 
   error(previous(), "Only identifiers can be called as functions.");
   return nullptr;
 }
 
-std::unique_ptr<ExprNode> Parser::parseBuiltinCall() {
-  const LoomToken& builtin_token = previous();
+ExprNode* Parser::parseBuiltinCall() {
+  const LoomToken builtin_token = previous();
 
   // Extract the builtin name (remove the $$ prefix)
-  std::string builtin_name = builtin_token.value.substr(2);  // Remove "$$"
+  std::string_view builtin_name = textOf(builtin_token).substr(2);
 
   // Expect opening parenthesis
   consume(TokenType::TOKEN_LEFT_PAREN, "Expected '(' after builtin name.");
 
   // Parse arguments (same as regular function calls)
-  std::vector<std::unique_ptr<ExprNode>> arguments;
+  std::vector<ExprNode*> arguments;
   if (!check(TokenType::TOKEN_RIGHT_PAREN)) {
     do {
       arguments.push_back(parseExpression());
@@ -328,6 +349,6 @@ std::unique_ptr<ExprNode> Parser::parseBuiltinCall() {
   consume(TokenType::TOKEN_RIGHT_PAREN,
           "Expected ')' after builtin arguments.");
 
-  return std::make_unique<BuiltinCallExpr>(builtin_token.location, builtin_name,
-                                           std::move(arguments));
+  return arena.create<BuiltinCallExpr>(locationOf(builtin_token), builtin_name,
+                                       arena.copy(arguments));
 }
\ No newline at end of file
@@ -1,12 +1,23 @@
 // parser_internal.hh
 #pragma once
 
+#include <iostream>
 #include <memory>
+#include <span>
 #include <stdexcept>
+#include <string_view>
 #include <vector>
 
+#include "../common/arena.hh"
+#include "../scanner/token_stream.hh"
 #include "ast.hh"
 
+// Files at least this large are parsed with lazy function bodies, see
+// Parser::setLazyFunctionBodies
+constexpr size_t kLazyBodyThreshold = size_t{1} << 20;
+// Sources at least this large are parsed by parseParallel
+constexpr size_t kParallelParseThreshold = size_t{256} << 10;
+
 class ParseError : public std::runtime_error {
  public:
   using std::runtime_error::runtime_error;
@@ -14,44 +25,89 @@ class ParseError : public std::runtime_error {
 
 class Parser {
  private:
-  const std::vector<LoomToken>& tokens;
-  size_t current = 0;
+  TokenStream& tokens;
+  const LoomSourceFile& file;  // buffer the token offsets refer to
+  Arena& arena;                // owns the nodes built
+  LoomToken previous_token{};  // last consumed token; the stream drops it
   bool had_error = false;
+  bool lazy_function_bodies = false;
+  std::ostream& diagnostics;  // where parse errors are reported
 
   void advance();
   const LoomToken& peek() const;
   const LoomToken& previous() const;
+  std::string_view textOf(const LoomToken& token) const;
+  LoomSourceLocation locationOf(const LoomToken& token) const;
   bool isAtEnd() const;
   bool check(TokenType type) const;
   bool match(TokenType type);
   void consume(TokenType type, const std::string& message);
   void error(const LoomToken& token, const std::string& message);
   void synchronize();
-  std::unique_ptr<StmtNode> parseDeclaration();
-  std::unique_ptr<StmtNode> parseVarDeclaration(VarDeclKind kind);
-  std::unique_ptr<StmtNode> parseIfStatement();
-  std::unique_ptr<StmtNode> parseWhileStatement();
-  std::unique_ptr<StmtNode> parseFunctionDeclaration();
-  std::unique_ptr<StmtNode> parseReturnStatement();
-  std::unique_ptr<StmtNode> parseDeferStatement();
-  std::unique_ptr<StmtNode> parseUnsafeBlock();
-  std::unique_ptr<ParameterNode> parseParameter();
-  std::unique_ptr<StmtNode> parseExpressionStatement();
-  std::unique_ptr<ExprNode> parseExpression();
-  std::unique_ptr<ExprNode> parseAssignment();
-  std::unique_ptr<ExprNode> parseEquality();
-  std::unique_ptr<ExprNode> parseComparison();
-  std::unique_ptr<ExprNode> parseTerm();
-  std::unique_ptr<ExprNode> parseFactor();
-  std::unique_ptr<ExprNode> parseUnary();
-  std::unique_ptr<ExprNode> parseCall();
-  std::unique_ptr<ExprNode> parsePrimary();
-  std::unique_ptr<ExprNode> parseBuiltinCall();
-  std::unique_ptr<ExprNode> finishCall(std::unique_ptr<ExprNode> callee);
-  std::unique_ptr<TypeNode> parseType();
+  StmtNode* parseDeclaration();
+  StmtNode* parseVarDeclaration(VarDeclKind kind);
+  StmtNode* parseIfStatement();
+  StmtNode* parseWhileStatement();
+  StmtNode* parseFunctionDeclaration();
+  void skipFunctionBody();
+  StmtNode* parseReturnStatement();
+  StmtNode* parseDeferStatement();
+  StmtNode* parseUnsafeBlock();
+  ParameterNode* parseParameter();
+  StmtNode* parseExpressionStatement();
+  ExprNode* parseExpression();
+  ExprNode* parseAssignment();
+  ExprNode* parseBinary(int min_precedence);
+  ExprNode* parseUnary();
+  ExprNode* parseCall();
+  ExprNode* parsePrimary();
+  ExprNode* parseBuiltinCall();
+  ExprNode* finishCall(ExprNode* callee);
+  TypeNode* parseType();
 
  public:
-  Parser(const std::vector<LoomToken>& tokens);
-  std::vector<std::unique_ptr<StmtNode>> parse();
+  Parser(TokenStream& tokens, const LoomSourceFile& file, Arena& arena,
+         std::ostream& diagnostics = std::cerr);
+  // Top-level statements; the nodes are owned by the arena
+  std::vector<StmtNode*> parse();
   bool hasError() const { return had_error; }
-};
\ No newline at end of file
+
+  // When set, parse() only brace-matches the bodies of function
+  // declarations and leaves them pending (FunctionDeclNode::body_pending),
+  // so a function nobody calls costs no more than scanning it. Syntax
+  // errors in a skipped body are only reported once it is parsed.
+  void setLazyFunctionBodies(bool lazy) { lazy_function_bodies = lazy; }
+
+  // Parses a pending body, with the tokens starting at its '{'
+  void parseFunctionBody(FunctionDeclNode& func);
+};
+
+// Parses the pending body of func, a function declared in file, into
+// arena. Returns false if there was a parse error, reported to diagnostics.
+bool parseSkippedBody(FunctionDeclNode& func, const LoomSourceFile& file,
+                      Arena& arena, std::ostream& diagnostics);
+
+// Indices at which tokens can be cut into ranges of roughly range_size
+// tokens that parse independently: each is a 'func', 'let', 'mut' or
+// 'define' at brace depth 0, right after the ';' or '}' that ended the
+// declaration before it. Always starts with 0.
+std::vector<size_t> findDeclarationBoundaries(
+    std::span<const LoomToken> tokens, size_t range_size);
+
+struct ParallelParseResult {
+  std::vector<StmtNode*> statements;  // top-level, in source order
+  std::vector<std::unique_ptr<Arena>> arenas;  // own the nodes
+  bool had_error = false;
+};
+
+// Parses file from its tokens (ending with TOKEN_EOF, e.g. from
+// scanParallel) on up to thread_count threads (0: one per core). Every
+// range between declaration boundaries gets its own parser and arena. If
+// any range has a syntax error the whole file is parsed again on the
+// calling thread, so diagnostics and error recovery are exactly those of
+// Parser::parse.
+ParallelParseResult parseParallel(std::span<const LoomToken> tokens,
+                                  const LoomSourceFile& file,
+                                  std::ostream& diagnostics,
+                                  bool lazy_function_bodies,
+                                  unsigned thread_count = 0);
\ No newline at end of file
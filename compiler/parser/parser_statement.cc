@@ -1,7 +1,7 @@
 // parser_statement.cc
 #include "parser_internal.hh"
 
-std::unique_ptr<StmtNode> Parser::parseDeclaration() {
+StmtNode* Parser::parseDeclaration() {
   try {
     // Skip newlines at the beginning of declarations
     while (match(TokenType::TOKEN_NEWLINE)) {
@@ -33,18 +33,18 @@ std::unique_ptr<StmtNode> Parser::parseDeclaration() {
   }
 }
 
-std::unique_ptr<StmtNode> Parser::parseVarDeclaration(VarDeclKind kind) {
-  const LoomToken& name_token = peek();
+StmtNode* Parser::parseVarDeclaration(VarDeclKind kind) {
+  const LoomToken name_token = peek();
   consume(TokenType::TOKEN_IDENTIFIER,
           "Expected variable name after 'let'/'mut'.");
-  std::string name = previous().value;
+  Symbol name = previous().symbol;
 
-  std::unique_ptr<TypeNode> type = nullptr;
+  TypeNode* type = nullptr;
   if (match(TokenType::TOKEN_COLON)) {
     type = parseType();
   }
 
-  std::unique_ptr<ExprNode> initializer = nullptr;
+  ExprNode* initializer = nullptr;
   if (match(TokenType::TOKEN_EQUAL)) {
     initializer = parseExpression();
   }
@@ -52,85 +52,84 @@ std::unique_ptr<StmtNode> Parser::parseVarDeclaration(VarDeclKind kind) {
   consume(TokenType::TOKEN_SEMICOLON,
           "Expected ';' after variable declaration.");
 
-  return std::make_unique<VarDeclNode>(name_token.location, name, kind,
-                                       std::move(type), std::move(initializer));
+  return arena.create<VarDeclNode>(locationOf(name_token), name, kind, type,
+                                   initializer);
 }
 
-std::unique_ptr<StmtNode> Parser::parseExpressionStatement() {
-  auto expr_loc = peek().location;
-  std::unique_ptr<ExprNode> expr = parseExpression();
+StmtNode* Parser::parseExpressionStatement() {
+  auto expr_loc = locationOf(peek());
+  ExprNode* expr = parseExpression();
   consume(TokenType::TOKEN_SEMICOLON, "Expected ';' after expression.");
-  return std::make_unique<ExprStmtNode>(expr_loc, std::move(expr));
+  return arena.create<ExprStmtNode>(expr_loc, expr);
 }
 
-std::unique_ptr<StmtNode> Parser::parseIfStatement() {
-  auto if_loc = previous().location;  // 'if' token location
+StmtNode* Parser::parseIfStatement() {
+  auto if_loc = locationOf(previous());  // 'if' token location
 
   consume(TokenType::TOKEN_LEFT_PAREN, "Expected '(' after 'if'.");
-  std::unique_ptr<ExprNode> condition = parseExpression();
+  ExprNode* condition = parseExpression();
   consume(TokenType::TOKEN_RIGHT_PAREN, "Expected ')' after if condition.");
 
   consume(TokenType::TOKEN_LEFT_BRACE, "Expected '{' before if body.");
-  std::vector<std::unique_ptr<StmtNode>> then_body;
+  std::vector<StmtNode*> then_body;
 
   // Parse statements until we hit '}'
   while (!check(TokenType::TOKEN_RIGHT_BRACE) && !isAtEnd()) {
     if (auto stmt = parseDeclaration()) {
-      then_body.push_back(std::move(stmt));
+      then_body.push_back(stmt);
     }
   }
   consume(TokenType::TOKEN_RIGHT_BRACE, "Expected '}' after if body.");
 
-  std::vector<std::unique_ptr<StmtNode>> else_body;
+  std::vector<StmtNode*> else_body;
   if (match(TokenType::TOKEN_KEYWORD_ELSE)) {
     consume(TokenType::TOKEN_LEFT_BRACE, "Expected '{' before else body.");
 
     while (!check(TokenType::TOKEN_RIGHT_BRACE) && !isAtEnd()) {
       if (auto stmt = parseDeclaration()) {
-        else_body.push_back(std::move(stmt));
+        else_body.push_back(stmt);
       }
     }
     consume(TokenType::TOKEN_RIGHT_BRACE, "Expected '}' after else body.");
   }
 
-  return std::make_unique<IfStmtNode>(
-      if_loc, std::move(condition), std::move(then_body), std::move(else_body));
+  return arena.create<IfStmtNode>(if_loc, condition, arena.copy(then_body),
+                                  arena.copy(else_body));
 }
 
-std::unique_ptr<StmtNode> Parser::parseWhileStatement() {
-  auto while_loc = previous().location;  // location of the 'while' token
+StmtNode* Parser::parseWhileStatement() {
+  auto while_loc = locationOf(previous());  // location of the 'while' token
 
   consume(TokenType::TOKEN_LEFT_PAREN, "Expected '(' after 'while'.");
-  std::unique_ptr<ExprNode> condition = parseExpression();
+  ExprNode* condition = parseExpression();
   consume(TokenType::TOKEN_RIGHT_PAREN, "Expected ')' after while condition.");
 
   consume(TokenType::TOKEN_LEFT_BRACE, "Expected '{' before while body.");
-  std::vector<std::unique_ptr<StmtNode>> body;
+  std::vector<StmtNode*> body;
 
   while (!check(TokenType::TOKEN_RIGHT_BRACE) && !isAtEnd()) {
     if (auto stmt = parseDeclaration()) {
-      body.push_back(std::move(stmt));
+      body.push_back(stmt);
     }
   }
 
   consume(TokenType::TOKEN_RIGHT_BRACE, "Expected '}' after while body.");
 
-  return std::make_unique<WhileStmtNode>(while_loc, std::move(condition),
-                                         std::move(body));
+  return arena.create<WhileStmtNode>(while_loc, condition, arena.copy(body));
 }
 
 // Parse function declaration: func name(param1: type1, param2: type2) ->
 // return_type { body }
-std::unique_ptr<StmtNode> Parser::parseFunctionDeclaration() {
-  LoomSourceLocation func_loc = previous().location;
+StmtNode* Parser::parseFunctionDeclaration() {
+  LoomSourceLocation func_loc = locationOf(previous());
 
   // Function name
   consume(TokenType::TOKEN_IDENTIFIER, "Expected function name after 'func'.");
-  std::string func_name = previous().value;
+  Symbol func_name = previous().symbol;
 
   // Parameters
   consume(TokenType::TOKEN_LEFT_PAREN, "Expected '(' after function name.");
-  std::vector<std::unique_ptr<ParameterNode>> parameters;
+  std::vector<ParameterNode*> parameters;
 
   if (!check(TokenType::TOKEN_RIGHT_PAREN)) {
     do {
@@ -141,79 +140,124 @@ std::unique_ptr<StmtNode> Parser::parseFunctionDeclaration() {
   consume(TokenType::TOKEN_RIGHT_PAREN, "Expected ')' after parameters.");
 
   // Return type (optional, default to void)
-  std::unique_ptr<TypeNode> return_type = nullptr;
+  TypeNode* return_type = nullptr;
   if (!check(TokenType::TOKEN_LEFT_BRACE)) {
     return_type = parseType();
   }
 
   // Function body
+  const LoomToken open_brace = peek();
   consume(TokenType::TOKEN_LEFT_BRACE, "Expected '{' before function body.");
-  std::vector<std::unique_ptr<StmtNode>> body;
+
+  if (lazy_function_bodies) {
+    skipFunctionBody();
+    auto func = arena.create<FunctionDeclNode>(
+        func_loc, func_name, arena.copy(parameters), return_type,
+        NodeList<StmtNode>{});
+    func->body_pending = true;
+    func->body_begin = locationOf(open_brace);
+    func->body_length =
+        previous().offset + previous().length - open_brace.offset;
+    return func;
+  }
+
+  std::vector<StmtNode*> body;
+
+  while (!check(TokenType::TOKEN_RIGHT_BRACE) && !isAtEnd()) {
+    if (auto stmt = parseDeclaration()) {
+      body.push_back(stmt);
+    }
+  }
+
+  consume(TokenType::TOKEN_RIGHT_BRACE, "Expected '}' after function body.");
+
+  return arena.create<FunctionDeclNode>(func_loc, func_name,
+                                        arena.copy(parameters), return_type,
+                                        arena.copy(body));
+}
+
+// Skips to the '}' matching the '{' just consumed, looking at nothing but
+// braces
+void Parser::skipFunctionBody() {
+  size_t depth = 1;
+  while (!isAtEnd()) {
+    advance();
+    if (previous().type == TokenType::TOKEN_LEFT_BRACE) {
+      ++depth;
+    } else if (previous().type == TokenType::TOKEN_RIGHT_BRACE &&
+               --depth == 0) {
+      return;
+    }
+  }
+  error(peek(), "Expected '}' after function body.");
+}
+
+void Parser::parseFunctionBody(FunctionDeclNode& func) {
+  consume(TokenType::TOKEN_LEFT_BRACE, "Expected '{' before function body.");
+  std::vector<StmtNode*> body;
 
   while (!check(TokenType::TOKEN_RIGHT_BRACE) && !isAtEnd()) {
     if (auto stmt = parseDeclaration()) {
-      body.push_back(std::move(stmt));
+      body.push_back(stmt);
     }
   }
 
   consume(TokenType::TOKEN_RIGHT_BRACE, "Expected '}' after function body.");
 
-  return std::make_unique<FunctionDeclNode>(
-      func_loc, func_name, std::move(parameters), std::move(return_type),
-      std::move(body));
+  func.body = arena.copy(body);
+  func.body_pending = false;
 }
 
 // Parse return statement: return expression;
-std::unique_ptr<StmtNode> Parser::parseReturnStatement() {
-  LoomSourceLocation return_loc = previous().location;
+StmtNode* Parser::parseReturnStatement() {
+  LoomSourceLocation return_loc = locationOf(previous());
 
-  std::unique_ptr<ExprNode> expression = nullptr;
+  ExprNode* expression = nullptr;
   if (!check(TokenType::TOKEN_SEMICOLON)) {
     expression = parseExpression();
   }
 
   consume(TokenType::TOKEN_SEMICOLON, "Expected ';' after return statement.");
 
-  return std::make_unique<ReturnStmtNode>(return_loc, std::move(expression));
+  return arena.create<ReturnStmtNode>(return_loc, expression);
 }
 
 // Parse parameter: name: type
-std::unique_ptr<ParameterNode> Parser::parseParameter() {
-  LoomSourceLocation param_loc = peek().location;
+ParameterNode* Parser::parseParameter() {
+  LoomSourceLocation param_loc = locationOf(peek());
 
   consume(TokenType::TOKEN_IDENTIFIER, "Expected parameter name.");
-  std::string param_name = previous().value;
+  Symbol param_name = previous().symbol;
 
   consume(TokenType::TOKEN_COLON, "Expected ':' after parameter name.");
-  std::unique_ptr<TypeNode> param_type = parseType();
+  TypeNode* param_type = parseType();
 
-  return std::make_unique<ParameterNode>(param_loc, param_name,
-                                         std::move(param_type));
+  return arena.create<ParameterNode>(param_loc, param_name, param_type);
 }
 
 // Parse defer statement: defer statement
-std::unique_ptr<StmtNode> Parser::parseDeferStatement() {
-  LoomSourceLocation defer_loc = previous().location;
+StmtNode* Parser::parseDeferStatement() {
+  LoomSourceLocation defer_loc = locationOf(previous());
 
   // Parse the statement to be deferred
-  std::unique_ptr<StmtNode> deferred_stmt = parseExpressionStatement();
+  StmtNode* deferred_stmt = parseExpressionStatement();
 
-  return std::make_unique<DeferStmtNode>(defer_loc, std::move(deferred_stmt));
+  return arena.create<DeferStmtNode>(defer_loc, deferred_stmt);
 }
 
 // Parse unsafe block: unsafe { statements }
-std::unique_ptr<StmtNode> Parser::parseUnsafeBlock() {
-  LoomSourceLocation unsafe_loc = previous().location;
+StmtNode* Parser::parseUnsafeBlock() {
+  LoomSourceLocation unsafe_loc = locationOf(previous());
 
   consume(TokenType::TOKEN_LEFT_BRACE, "Expected '{' after 'unsafe'");
 
-  std::vector<std::unique_ptr<StmtNode>> statements;
+  std::vector<StmtNode*> statements;
 
   // Parse statements until we hit the closing brace
   while (!check(TokenType::TOKEN_RIGHT_BRACE) && !isAtEnd()) {
     auto stmt = parseDeclaration();
     if (stmt) {
-      statements.push_back(std::move(stmt));
+      statements.push_back(stmt);
     }
   }
 
@@ -222,6 +266,6 @@ std::unique_ptr<StmtNode> Parser::parseUnsafeBlock() {
   // For now, wrap it as an expression statement containing an unsafe block
   // expression
   auto unsafe_expr =
-      std::make_unique<UnsafeBlockExpr>(unsafe_loc, std::move(statements));
-  return std::make_unique<ExprStmtNode>(unsafe_loc, std::move(unsafe_expr));
+      arena.create<UnsafeBlockExpr>(unsafe_loc, arena.copy(statements));
+  return arena.create<ExprStmtNode>(unsafe_loc, unsafe_expr);
 }
\ No newline at end of file
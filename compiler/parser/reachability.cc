@@ -0,0 +1,156 @@
+// compiler/parser/reachability.cc
+#include "reachability.hh"
+
+#include <unordered_map>
+#include <unordered_set>
+
+static const Symbol main_symbol = Symbol::intern("main");
+
+// Worklist of reached functions whose bodies still have to be walked
+class ReachabilityWalker {
+ public:
+  ReachabilityWalker(const std::vector<StmtNode*>& ast,
+                     const std::function<bool(FunctionDeclNode&)>& parse_body)
+      : parse_body(parse_body) {
+    for (StmtNode* stmt : ast) {
+      if (auto* func = dyn_cast<FunctionDeclNode>(stmt)) {
+        functions.emplace(func->name, func);
+      }
+    }
+  }
+
+  bool run(const std::vector<StmtNode*>& ast) {
+    for (StmtNode* stmt : ast) {
+      auto* func = dyn_cast<FunctionDeclNode>(stmt);
+      if (!func) {
+        walk(stmt);
+      } else if (!func->body_pending || func->name == main_symbol) {
+        reach(func);
+      }
+    }
+    while (!worklist.empty()) {
+      FunctionDeclNode* func = worklist.back();
+      worklist.pop_back();
+      walk(func->body);
+    }
+    return ok;
+  }
+
+ private:
+  const std::function<bool(FunctionDeclNode&)>& parse_body;
+  // Every top-level function by name; a duplicate name is sema's to
+  // report, so all functions of that name are reached together
+  std::unordered_multimap<Symbol, FunctionDeclNode*> functions;
+  std::vector<FunctionDeclNode*> worklist;
+  std::unordered_set<FunctionDeclNode*> reached;
+  bool ok = true;
+
+  void reach(FunctionDeclNode* func) {
+    if (!reached.insert(func).second) return;
+    if (func->body_pending && !parse_body(*func)) {
+      ok = false;
+      return;
+    }
+    worklist.push_back(func);
+  }
+
+  void call(Symbol name) {
+    auto [first, last] = functions.equal_range(name);
+    for (auto it = first; it != last; ++it) {
+      reach(it->second);
+    }
+  }
+
+  template <typename T>
+  void walk(NodeList<T> nodes) {
+    for (T* node : nodes) {
+      walk(node);
+    }
+  }
+
+  // Finds the calls in a statement or expression
+  void walk(ASTNode* node) {
+    if (!node) return;
+    switch (node->getKind()) {
+      case NodeKind::VarDeclNode:
+        walk(cast<VarDeclNode>(node)->initializer);
+        break;
+      case NodeKind::FunctionDeclNode:
+        // A nested function is reached with the code around it
+        reach(cast<FunctionDeclNode>(node));
+        break;
+      case NodeKind::ReturnStmtNode:
+        walk(cast<ReturnStmtNode>(node)->expression);
+        break;
+      case NodeKind::ExprStmtNode:
+        walk(cast<ExprStmtNode>(node)->expression);
+        break;
+      case NodeKind::IfStmtNode: {
+        auto* if_stmt = cast<IfStmtNode>(node);
+        walk(if_stmt->condition);
+        walk(if_stmt->then_body);
+        walk(if_stmt->else_body);
+        break;
+      }
+      case NodeKind::WhileStmtNode: {
+        auto* while_stmt = cast<WhileStmtNode>(node);
+        walk(while_stmt->condition);
+        walk(while_stmt->body);
+        break;
+      }
+      case NodeKind::DeferStmtNode:
+        walk(cast<DeferStmtNode>(node)->deferred_statement);
+        break;
+      case NodeKind::AssignmentExpr:
+        walk(cast<AssignmentExpr>(node)->value);
+        break;
+      case NodeKind::BinaryExpr:
+        walk(cast<BinaryExpr>(node)->left);
+        walk(cast<BinaryExpr>(node)->right);
+        break;
+      case NodeKind::UnaryExpr:
+        walk(cast<UnaryExpr>(node)->right);
+        break;
+      case NodeKind::FunctionCallExpr: {
+        auto* call_expr = cast<FunctionCallExpr>(node);
+        call(call_expr->function_name);
+        walk(call_expr->arguments);
+        break;
+      }
+      case NodeKind::BuiltinCallExpr:
+        walk(cast<BuiltinCallExpr>(node)->arguments);
+        break;
+      case NodeKind::ReferenceExpr:
+        walk(cast<ReferenceExpr>(node)->operand);
+        break;
+      case NodeKind::DereferenceExpr:
+        walk(cast<DereferenceExpr>(node)->operand);
+        break;
+      case NodeKind::MemberAccessExpr:
+        walk(cast<MemberAccessExpr>(node)->object);
+        break;
+      case NodeKind::PointerAccessExpr:
+        walk(cast<PointerAccessExpr>(node)->pointer);
+        break;
+      case NodeKind::SliceExpr: {
+        auto* slice = cast<SliceExpr>(node);
+        walk(slice->array);
+        walk(slice->start);
+        walk(slice->end);
+        break;
+      }
+      case NodeKind::UnsafeBlockExpr:
+        walk(cast<UnsafeBlockExpr>(node)->statements);
+        break;
+      default:
+        // Literals, identifiers and types call nothing
+        break;
+    }
+  }
+};
+
+bool parseReachableBodies(
+    const std::vector<StmtNode*>& ast,
+    const std::function<bool(FunctionDeclNode&)>& parse_body) {
+  return ReachabilityWalker(ast, parse_body).run(ast);
+}
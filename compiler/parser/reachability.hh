@@ -0,0 +1,18 @@
+// compiler/parser/reachability.hh
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "ast.hh"
+
+// Parses the pending bodies (see Parser::setLazyFunctionBodies) of every
+// function the program can reach and leaves all others pending, so sema
+// and codegen skip them. Reachability starts at main, the top-level
+// statements that aren't functions, and every function parsed up front;
+// a function is reached once a reached body calls it. parse_body parses
+// one pending body and returns false on a parse error.
+// Returns false if a body failed to parse.
+bool parseReachableBodies(
+    const std::vector<StmtNode*>& ast,
+    const std::function<bool(FunctionDeclNode&)>& parse_body);
@@ -1,8 +1,177 @@
-#include <unordered_map>
-
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <iterator>
+
+#include "../common/thread_pool.hh"
+#include "../common/time_report.hh"
+#include "llvm/ADT/APFloat.h"
+#include "llvm/Support/Error.h"
 #include "scanner_internal.hh"
 
-static const std::unordered_map<std::string_view, TokenType> keywords = {
+// The hot loops of the scanner (whitespace, identifiers, string bodies and
+// comments) classify a whole block of bytes per step. SSE2 is always there
+// on x86-64; the AVX2 variant is used when the compiler targets it (e.g.
+// -march=native). Other targets and the tail of the buffer use plain loops.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LOOM_SCANNER_SIMD 1
+using ByteBlock = __m256i;
+static constexpr size_t kBlockSize = 32;
+static ByteBlock loadBlock(const char* p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+static ByteBlock splat(char c) { return _mm256_set1_epi8(c); }
+static ByteBlock equal(ByteBlock a, ByteBlock b) {
+  return _mm256_cmpeq_epi8(a, b);
+}
+static ByteBlock less(ByteBlock a, ByteBlock b) {
+  return _mm256_cmpgt_epi8(b, a);
+}
+static ByteBlock either(ByteBlock a, ByteBlock b) {
+  return _mm256_or_si256(a, b);
+}
+static ByteBlock add(ByteBlock a, ByteBlock b) {
+  return _mm256_add_epi8(a, b);
+}
+static uint32_t bitmask(ByteBlock v) {
+  return static_cast<uint32_t>(_mm256_movemask_epi8(v));
+}
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LOOM_SCANNER_SIMD 1
+using ByteBlock = __m128i;
+static constexpr size_t kBlockSize = 16;
+static ByteBlock loadBlock(const char* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+static ByteBlock splat(char c) { return _mm_set1_epi8(c); }
+static ByteBlock equal(ByteBlock a, ByteBlock b) {
+  return _mm_cmpeq_epi8(a, b);
+}
+static ByteBlock less(ByteBlock a, ByteBlock b) { return _mm_cmplt_epi8(a, b); }
+static ByteBlock either(ByteBlock a, ByteBlock b) { return _mm_or_si128(a, b); }
+static ByteBlock add(ByteBlock a, ByteBlock b) { return _mm_add_epi8(a, b); }
+static uint32_t bitmask(ByteBlock v) {
+  return static_cast<uint32_t>(_mm_movemask_epi8(v));
+}
+#endif
+
+#ifdef LOOM_SCANNER_SIMD
+// Marks the bytes in [lo, hi]. Shifting lo to -128 turns the unsigned range
+// check into a single signed compare.
+static ByteBlock inRange(ByteBlock v, char lo, char hi) {
+  ByteBlock shifted = add(v, splat(static_cast<char>(-128 - lo)));
+  return less(shifted, splat(static_cast<char>(-128 + (hi - lo) + 1)));
+}
+
+// Index of the first byte of a block that is not marked, or kBlockSize
+static size_t firstUnmarked(ByteBlock marked) {
+  uint32_t rest = ~bitmask(marked);
+  return rest ? static_cast<size_t>(std::countr_zero(rest)) : kBlockSize;
+}
+#endif
+
+static bool isWhitespaceChar(char c) {
+  return c == ' ' || c == '\r' || c == '\t';
+}
+
+static bool isIdentifierChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_';
+}
+
+// Offset of the first byte at or after pos that is not ' ', '\r' or '\t'
+static size_t skipWhitespaceChars(std::string_view source, size_t pos) {
+#ifdef LOOM_SCANNER_SIMD
+  for (; pos + kBlockSize <= source.size(); pos += kBlockSize) {
+    ByteBlock block = loadBlock(source.data() + pos);
+    ByteBlock marked = either(equal(block, splat(' ')),
+                              either(equal(block, splat('\r')),
+                                     equal(block, splat('\t'))));
+    size_t run = firstUnmarked(marked);
+    if (run < kBlockSize) return pos + run;
+  }
+#endif
+  while (pos < source.size() && isWhitespaceChar(source[pos])) pos++;
+  return pos;
+}
+
+// Offset of the first byte at or after pos that is not [A-Za-z0-9_]
+static size_t skipIdentifierChars(std::string_view source, size_t pos) {
+#ifdef LOOM_SCANNER_SIMD
+  for (; pos + kBlockSize <= source.size(); pos += kBlockSize) {
+    ByteBlock block = loadBlock(source.data() + pos);
+    // Setting bit 5 maps 'A'-'Z' onto 'a'-'z'
+    ByteBlock letters = inRange(either(block, splat(0x20)), 'a', 'z');
+    ByteBlock marked = either(either(letters, inRange(block, '0', '9')),
+                              equal(block, splat('_')));
+    size_t run = firstUnmarked(marked);
+    if (run < kBlockSize) return pos + run;
+  }
+#endif
+  while (pos < source.size() && isIdentifierChar(source[pos])) pos++;
+  return pos;
+}
+
+// Offset of the next '"' or '\\' at or after pos, or the end of the source
+static size_t findStringSpecial(std::string_view source, size_t pos) {
+#ifdef LOOM_SCANNER_SIMD
+  for (; pos + kBlockSize <= source.size(); pos += kBlockSize) {
+    ByteBlock block = loadBlock(source.data() + pos);
+    uint32_t found = bitmask(either(equal(block, splat('"')),
+                                    equal(block, splat('\\'))));
+    if (found) return pos + static_cast<size_t>(std::countr_zero(found));
+  }
+#endif
+  while (pos < source.size() && source[pos] != '"' && source[pos] != '\\') {
+    pos++;
+  }
+  return pos;
+}
+
+// Offset of the next occurrence of c at or after pos, or the end of the
+// source. memchr is already vectorized by the C library.
+static size_t findChar(std::string_view source, size_t pos, char c) {
+  if (pos >= source.size()) return source.size();
+  const void* found =
+      std::memchr(source.data() + pos, c, source.size() - pos);
+  if (!found) return source.size();
+  return static_cast<size_t>(static_cast<const char*>(found) - source.data());
+}
+
+// Offset of the next '\n', '"' or '/' at or after pos, or the end of the
+// source. These are the only bytes findChunkBoundaries has to look at.
+static size_t findBoundarySpecial(std::string_view source, size_t pos) {
+#ifdef LOOM_SCANNER_SIMD
+  for (; pos + kBlockSize <= source.size(); pos += kBlockSize) {
+    ByteBlock block = loadBlock(source.data() + pos);
+    uint32_t found = bitmask(either(equal(block, splat('\n')),
+                                    either(equal(block, splat('"')),
+                                           equal(block, splat('/')))));
+    if (found) return pos + static_cast<size_t>(std::countr_zero(found));
+  }
+#endif
+  while (pos < source.size() && source[pos] != '\n' && source[pos] != '"' &&
+         source[pos] != '/') {
+    pos++;
+  }
+  return pos;
+}
+
+// The keyword set. Only this list has to change when a keyword is added;
+// the lookup table below is derived from it at compile time.
+struct Keyword {
+  std::string_view spelling;
+  TokenType type;
+};
+
+static constexpr Keyword keywords[] = {
     {"let", TokenType::TOKEN_KEYWORD_LET},
     {"mut", TokenType::TOKEN_KEYWORD_MUT},
     {"define", TokenType::TOKEN_KEYWORD_DEFINE},
@@ -19,6 +188,65 @@ static const std::unordered_map<std::string_view, TokenType> keywords = {
     {"null", TokenType::TOKEN_KEYWORD_NULL},
 };
 
+static constexpr size_t kKeywordCount = std::size(keywords);
+
+// Hashes the length and the first, second, middle and last character of a
+// non-empty identifier. That tells all keywords apart without a loop over
+// the whole text.
+static constexpr uint32_t keywordHash(std::string_view text, uint32_t seed) {
+  uint32_t hash = seed;
+  auto mix = [&hash](uint32_t part) { hash = (hash ^ part) * 0x01000193u; };
+  mix(static_cast<uint32_t>(text.size()));
+  mix(static_cast<uint8_t>(text[0]));
+  mix(static_cast<uint8_t>(text[text.size() > 1 ? 1 : 0]));
+  mix(static_cast<uint8_t>(text[text.size() / 2]));
+  mix(static_cast<uint8_t>(text.back()));
+  return hash ^ (hash >> 16);
+}
+
+// Perfect hash table: every keyword has a slot of its own, so a lookup is
+// one hash and at most one string compare.
+struct KeywordTable {
+  uint32_t seed = 0;
+  uint32_t mask = 0;
+  std::array<int8_t, 256> slots{};  // index into keywords, -1 if empty
+};
+
+// Tries seeds and table sizes until no two keywords share a slot
+static constexpr KeywordTable buildKeywordTable() {
+  for (uint32_t size = 16; size <= 256; size *= 2) {
+    if (size < 2 * kKeywordCount) continue;
+    for (uint32_t seed = 1; seed < 1000; ++seed) {
+      KeywordTable table;
+      table.seed = seed;
+      table.mask = size - 1;
+      table.slots.fill(-1);
+      bool collision = false;
+      for (size_t i = 0; i < kKeywordCount && !collision; ++i) {
+        uint32_t slot = keywordHash(keywords[i].spelling, seed) & table.mask;
+        collision = table.slots[slot] >= 0;
+        table.slots[slot] = static_cast<int8_t>(i);
+      }
+      if (!collision) return table;
+    }
+  }
+  return KeywordTable{};
+}
+
+static constexpr KeywordTable keyword_table = buildKeywordTable();
+static_assert(keyword_table.mask != 0,
+              "no collision-free hash found for the keyword set");
+
+// Keyword token type of an identifier, or TOKEN_IDENTIFIER
+static TokenType lookupKeyword(std::string_view text) {
+  uint32_t slot = keywordHash(text, keyword_table.seed) & keyword_table.mask;
+  int8_t index = keyword_table.slots[slot];
+  if (index >= 0 && keywords[index].spelling == text) {
+    return keywords[index].type;
+  }
+  return TokenType::TOKEN_IDENTIFIER;
+}
+
 bool Scanner::isAtEnd() { return current_offset >= source_buffer.length(); }
 
 char Scanner::advance() {
@@ -29,7 +257,6 @@ char Scanner::advance() {
   temp_char = source_buffer[current_offset];
 
   current_offset++;
-  current_column++;
 
   return temp_char;
 }
@@ -62,112 +289,256 @@ char Scanner::peek_next_next() {
 }
 
 void Scanner::skipWhitespace() {
-  while (!isAtEnd()) {
-    switch (peek()) {
-      case ' ':
-      case '\r':
-      case '\t':
-        advance();
-        break;
-      case '\n':
-        return;
-      default:
-        return;
-    }
-  }
+  // Newlines are tokens of their own and are not skipped
+  current_offset = skipWhitespaceChars(source_buffer, current_offset);
 }
 
 Scanner::Scanner(std::string_view source, std::string_view filename_)
     : filename(filename_),
       source_buffer(source),
       current_offset(0),
-      current_line(1),
-      current_column(1),
-      current_line_offset(0) {}
-
-LoomSourceLocation Scanner::getCurrentLocation() {
-  return LoomSourceLocation(filename, current_line, current_column,
-                            current_offset);
-}
+      start_offset(0) {}
 
 LoomToken Scanner::makeToken(TokenType type) {
-  std::string_view token_text =
-      source_buffer.substr(start_offset, current_offset - start_offset);
-
-  size_t start_column = start_offset - current_line_offset + 1;
-
-  LoomSourceLocation loc(filename, current_line, start_column, start_offset);
+  size_t length = current_offset - start_offset;
+  if (length > kMaxTokenLength) {
+    return makeErrorToken(ScanError::TokenTooLong);
+  }
+  return LoomToken{static_cast<uint32_t>(start_offset),
+                   static_cast<uint32_t>(length), type};
+}
 
-  return LoomToken(type, loc, std::string(token_text));
+LoomToken Scanner::makeErrorToken(ScanError kind, char offending_char) {
+  // Points at the offending character, or at the end of the source
+  size_t offset = current_offset > 0 ? current_offset - 1 : 0;
+  LoomToken token{static_cast<uint32_t>(offset),
+                  current_offset > offset ? 1u : 0u, TokenType::TOKEN_ERROR};
+  token.error = {kind, true, offending_char};
+  error_message = scanErrorMessage(token);
+  return token;
 }
 
-LoomToken Scanner::makeErrorToken(const std::string& message,
-                                  char offending_char) {
-  LoomSourceLocation loc(filename, current_line, current_column - 1,
-                         current_offset - 1);
+LoomToken Scanner::makeErrorToken(ScanError kind) {
+  size_t length = std::min(current_offset - start_offset, kMaxTokenLength);
+  LoomToken token{static_cast<uint32_t>(start_offset),
+                  static_cast<uint32_t>(length), TokenType::TOKEN_ERROR};
+  token.error = {kind, false, '\0'};
+  error_message = scanErrorMessage(token);
+  return token;
+}
 
-  std::string error_message = message + ": '" + offending_char + "'";
+std::string scanErrorMessage(const LoomToken& token) {
+  std::string message;
+  switch (token.error.kind) {
+    case ScanError::TokenTooLong:
+      message = "Token is longer than 16 MiB";
+      break;
+    case ScanError::MisplacedDigitSeparator:
+      message = "Digit separator must be between digits";
+      break;
+    case ScanError::MissingDigitsAfterPrefix:
+      message = "Missing digits after number prefix";
+      break;
+    case ScanError::InvalidDigit:
+      message = "Invalid digit in number literal";
+      break;
+    case ScanError::IntegerTooLarge:
+      message = "Integer literal does not fit in 64 bits";
+      break;
+    case ScanError::FloatOutOfRange:
+      message = "Float literal is out of range";
+      break;
+    case ScanError::UnterminatedString:
+      message = "Unterminated string";
+      break;
+    case ScanError::InvalidBuiltinName:
+      message = "Invalid builtin name after '$$'";
+      break;
+    case ScanError::UnterminatedComment:
+      message = "Unterminated multiline comment";
+      break;
+    case ScanError::SingleDollar:
+      message = "Unexpected character '$'. Did you mean '$$' for builtin?";
+      break;
+    case ScanError::UnexpectedCharacter:
+      message = "Unexpected character";
+      break;
+  }
+  if (token.error.has_offending_char) {
+    message += ": '";
+    message += token.error.offending_char;
+    message += "'";
+  }
+  return message;
+}
 
-  return LoomToken(TokenType::TOKEN_ERROR, loc, error_message);
+// Value of c as a digit in the given radix (2, 8, 10 or 16), or -1
+static int digitValue(char c, unsigned radix) {
+  int value;
+  if (c >= '0' && c <= '9') {
+    value = c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    value = c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    value = c - 'A' + 10;
+  } else {
+    return -1;
+  }
+  return value < static_cast<int>(radix) ? value : -1;
 }
 
+// Literals are decoded here, once; the parser, sema and codegen only use
+// the value on the token.
 LoomToken Scanner::scanNumber() {
-  // TODO: Check for different bases, e.g. 0x, 0b, 0o
-
-  while (isdigit(peek())) {
-    advance();
+  // 0x, 0o and 0b prefixes select the radix of an integer
+  unsigned radix = 10;
+  if (source_buffer[start_offset] == '0') {
+    switch (peek()) {
+      case 'x':
+        radix = 16;
+        break;
+      case 'o':
+        radix = 8;
+        break;
+      case 'b':
+        radix = 2;
+        break;
+      default:
+        break;
+    }
   }
-
-  if (peek() == '.' && isdigit(peek_next())) {
+  if (radix == 10) {
+    current_offset = start_offset;  // rescan the first digit below
+  } else {
     advance();
+  }
 
-    while (isdigit(peek())) {
+  // '_' separates digits, so it must sit between two of them
+  uint64_t value = 0;
+  bool overflow = false;
+  size_t digits = 0;
+  for (;;) {
+    char c = peek();
+    if (c == '_') {
       advance();
+      if (digits == 0 || digitValue(peek(), radix) < 0) {
+        return makeErrorToken(ScanError::MisplacedDigitSeparator, c);
+      }
+      continue;
     }
+    const int value_of_c = digitValue(c, radix);
+    if (value_of_c < 0) break;
+    const auto digit = static_cast<unsigned>(value_of_c);
+    advance();
+    digits++;
+    if (value > (UINT64_MAX - digit) / radix) {
+      overflow = true;
+    } else {
+      value = value * radix + digit;
+    }
+  }
 
-    return makeToken(TokenType::TOKEN_NUMBER_FLOAT);
+  if (radix != 10) {
+    if (digits == 0) {
+      return makeErrorToken(ScanError::MissingDigitsAfterPrefix,
+                            source_buffer[current_offset - 1]);
+    }
+    // e.g. the 2 in 0b102; it must not start a separate token
+    if (isIdentifierChar(peek())) {
+      char c = advance();
+      return makeErrorToken(ScanError::InvalidDigit, c);
+    }
+  } else if (peek() == '.' &&
+             (isdigit(peek_next()) || peek_next() == '_')) {
+    // A '_' right after the '.' is rejected by scanFloat
+    return scanFloat();
   }
 
-  return makeToken(TokenType::TOKEN_NUMBER_INT);
+  if (overflow) {
+    return makeErrorToken(ScanError::IntegerTooLarge);
+  }
+  LoomToken token = makeToken(TokenType::TOKEN_NUMBER_INT);
+  if (token.type == TokenType::TOKEN_NUMBER_INT) {
+    token.int_value = value;
+  }
+  return token;
 }
 
-LoomToken Scanner::scanIdentifier() {
-  while (isalnum(peek()) || peek() == '_') {
+LoomToken Scanner::scanFloat() {
+  // The integer part is consumed, the '.' is next
+  advance();
+  for (;;) {
+    if (peek() == '_') {
+      // Same rule as for integers: a digit on both sides, so not 1._5
+      const bool after_digit = isdigit(source_buffer[current_offset - 1]);
+      char c = advance();
+      if (!after_digit || !isdigit(peek())) {
+        return makeErrorToken(ScanError::MisplacedDigitSeparator, c);
+      }
+    }
+    if (!isdigit(peek())) break;
     advance();
   }
+  // Exponent, e.g. 1.0e-5
+  if (peek() == 'e' || peek() == 'E') {
+    char sign = peek_next();
+    if (isdigit(sign) ||
+        ((sign == '+' || sign == '-') && isdigit(peek_next_next()))) {
+      advance();
+      if (!isdigit(peek())) advance();
+      while (isdigit(peek())) advance();
+    }
+  }
+
+  LoomToken token = makeToken(TokenType::TOKEN_NUMBER_FLOAT);
+  if (token.type != TokenType::TOKEN_NUMBER_FLOAT) return token;
+
+  // APFloat rounds correctly and, unlike strtod, ignores the C locale
+  std::string spelling;
+  spelling.reserve(token.length);
+  for (char c : token.text(source_buffer)) {
+    if (c != '_') spelling += c;
+  }
+  llvm::APFloat value(llvm::APFloat::IEEEdouble());
+  auto status =
+      value.convertFromString(spelling, llvm::APFloat::rmNearestTiesToEven);
+  if (!status || (*status & llvm::APFloat::opOverflow)) {
+    if (!status) llvm::consumeError(status.takeError());
+    return makeErrorToken(ScanError::FloatOutOfRange);
+  }
+  token.float_value = value.convertToDouble();
+  return token;
+}
+
+LoomToken Scanner::scanIdentifier() {
+  current_offset = skipIdentifierChars(source_buffer, current_offset);
 
   std::string_view tmp_ident =
       source_buffer.substr(start_offset, current_offset - start_offset);
 
-  auto it = keywords.find(tmp_ident);
-
-  if (it != keywords.end()) {
-    return makeToken(it->second);
+  TokenType type = lookupKeyword(tmp_ident);
+  LoomToken token = makeToken(type);
+  if (type == TokenType::TOKEN_IDENTIFIER) {
+    // Interned once here; later phases only compare the ids
+    token.symbol = Symbol::intern(tmp_ident);
   }
-
-  return makeToken(TokenType::TOKEN_IDENTIFIER);
+  return token;
 }
 
 LoomToken Scanner::scanString() {
-  while (peek() != '"' && !isAtEnd()) {
-    if (peek() == '\n') {
-      current_line++;
-      current_column = 1;
-      current_line_offset = current_offset;
-      advance();
-    } else if (peek() == '\\') {
-      // Handle escape sequences: consume backslash and next character
-      advance();  // consume the backslash
-      if (!isAtEnd()) {
-        advance();  // consume the escaped character
-      }
-    } else {
-      advance();  // consume normal character
+  for (;;) {
+    // Jump over the plain characters up to the next quote or backslash
+    current_offset = findStringSpecial(source_buffer, current_offset);
+    if (isAtEnd() || peek() == '"') break;
+    // Handle escape sequences: consume backslash and next character
+    advance();  // consume the backslash
+    if (!isAtEnd()) {
+      advance();  // consume the escaped character
     }
   }
 
   if (isAtEnd()) {
-    return makeErrorToken("Unterminated string", '"');
+    return makeErrorToken(ScanError::UnterminatedString, '"');
   }
   // Consume the closing quote
   advance();
@@ -176,13 +547,11 @@ LoomToken Scanner::scanString() {
 
 LoomToken Scanner::scanBuiltin() {
   // We already consumed "$$", now scan the builtin name
-  while (isalnum(peek()) || peek() == '_') {
-    advance();
-  }
+  current_offset = skipIdentifierChars(source_buffer, current_offset);
 
   // Make sure we have a valid builtin name (at least one character after $$)
   if (current_offset - start_offset <= 2) {
-    return makeErrorToken("Invalid builtin name after '$$'", peek());
+    return makeErrorToken(ScanError::InvalidBuiltinName, peek());
   }
 
   return makeToken(TokenType::TOKEN_BUILTIN);
@@ -194,6 +563,9 @@ LoomToken Scanner::scanMultiLineComment() {
   advance();  // Third "
 
   while (!isAtEnd()) {
+    current_offset = findChar(source_buffer, current_offset, '"');
+    if (isAtEnd()) break;
+
     // Check for closing """
     if (peek() == '"' && peek_next() == '"' && peek_next_next() == '"') {
       // Consume the closing """
@@ -205,18 +577,11 @@ LoomToken Scanner::scanMultiLineComment() {
       return scanNextToken();
     }
 
-    // Handle newlines for proper line tracking
-    if (peek() == '\n') {
-      current_line++;
-      current_column = 1;
-      current_line_offset = current_offset;
-    }
-
     advance();
   }
 
   // If we reach here, the comment was not properly closed
-  return makeErrorToken("Unterminated multiline comment", '"');
+  return makeErrorToken(ScanError::UnterminatedComment, '"');
 }
 
 LoomToken Scanner::scanNextToken() {
@@ -233,14 +598,8 @@ LoomToken Scanner::scanNextToken() {
 
   if (isalpha(c)) return scanIdentifier();
   switch (c) {
-    case '\n': {
-      LoomToken token = makeToken(TokenType::TOKEN_NEWLINE);
-
-      current_line++;
-      current_column = 1;
-      current_line_offset = current_offset;
-      return token;
-    }
+    case '\n':
+      return makeToken(TokenType::TOKEN_NEWLINE);
     case '=':
       return (makeToken(match('=') ? TokenType::TOKEN_EQUAL_EQUAL
                                    : TokenType::TOKEN_EQUAL));
@@ -295,9 +654,7 @@ LoomToken Scanner::scanNextToken() {
     case '/':
       if (match('/')) {
         // Kommentar bis zum Zeilenende überspringen
-        while (peek() != '\n' && !isAtEnd()) {
-          advance();
-        }
+        current_offset = findChar(source_buffer, current_offset, '\n');
         // Rekursiv nächstes Token scannen (Kommentar überspringen)
         return scanNextToken();
       } else {
@@ -309,13 +666,198 @@ LoomToken Scanner::scanNextToken() {
         // $$builtin function - scan the identifier part
         return scanBuiltin();
       } else {
-        return makeErrorToken(
-            "Unexpected character '$'. Did you mean '$$' for builtin?", c);
+        return makeErrorToken(ScanError::SingleDollar, c);
       }
 
     default:
-      return makeErrorToken("Unexpected character", c);
+      return makeErrorToken(ScanError::UnexpectedCharacter, c);
+  }
+}
+
+// Chunks smaller than this aren't worth a task of their own
+static constexpr size_t kMinChunkSize = size_t{1} << 20;
+
+std::vector<size_t> findChunkBoundaries(std::string_view source,
+                                        size_t chunk_size) {
+  // Follows the scanner only as far as it matters for newlines: '"' and
+  // '/' outside of a string or comment always start a token, and nothing
+  // but strings, // and """ comments runs across a line end. Everything
+  // else is skipped.
+  std::vector<size_t> boundaries{0};
+  const size_t size = source.size();
+  size_t next_cut = chunk_size;
+  size_t pos = 0;
+  for (;;) {
+    pos = findBoundarySpecial(source, pos);
+    if (pos >= size) break;
+    char c = source[pos++];
+    if (c == '\n') {
+      if (pos >= next_cut && pos < size) {
+        boundaries.push_back(pos);
+        next_cut = pos + chunk_size;
+      }
+    } else if (c == '/') {
+      if (pos < size && source[pos] == '/') {
+        // The newline ending the comment is still seen by the next step
+        pos = findChar(source, pos + 1, '\n');
+      }
+    } else if (pos + 1 < size && source[pos] == '"' &&
+               source[pos + 1] == '"') {
+      // """ comment, closed by the first following """ as in
+      // scanMultiLineComment
+      pos += 2;
+      for (;;) {
+        pos = findChar(source, pos, '"');
+        if (pos + 2 >= size) return boundaries;  // unterminated
+        if (source[pos + 1] == '"' && source[pos + 2] == '"') break;
+        pos++;
+      }
+      pos += 3;
+    } else {
+      // String literal; a backslash escapes any byte, newlines included
+      for (;;) {
+        pos = findStringSpecial(source, pos);
+        if (pos >= size) return boundaries;  // unterminated
+        if (source[pos] == '"') break;
+        pos += 2;
+      }
+      pos++;
+    }
+  }
+  return boundaries;
+}
+
+// Scans source up to and including TOKEN_EOF; offsets are shifted by base
+static void scanChunk(std::string_view source, std::string_view filename,
+                      uint32_t base, std::vector<LoomToken>& tokens) {
+  Scanner scanner(source, filename);
+  for (;;) {
+    LoomToken token = scanner.scanNextToken();
+    token.offset += base;
+    tokens.push_back(token);
+    if (token.type == TokenType::TOKEN_EOF) break;
+  }
+}
+
+std::vector<LoomToken> scanParallel(std::string_view source,
+                                    std::string_view filename,
+                                    unsigned thread_count) {
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
   }
+  // A few chunks per thread even out chunks with very different density
+  size_t chunk_size =
+      std::max(kMinChunkSize, source.size() / (size_t{thread_count} * 4));
+  std::vector<size_t> boundaries = findChunkBoundaries(source, chunk_size);
+  boundaries.push_back(source.size());
+  const size_t chunk_count = boundaries.size() - 1;
+
+  std::vector<std::vector<LoomToken>> chunks(chunk_count);
+  if (chunk_count == 1) {
+    scanChunk(source, filename, 0, chunks[0]);
+  } else {
+    ThreadPool pool(static_cast<unsigned>(
+        std::min<size_t>(chunk_count, thread_count)));
+    std::vector<std::future<void>> jobs;
+    jobs.reserve(chunk_count);
+    // The workers' CPU time belongs to the caller's phase
+    TimeReport::Scope* phase = TimeReport::Scope::current();
+    for (size_t i = 0; i < chunk_count; ++i) {
+      jobs.push_back(pool.submit([&, i]() {
+        TimeReport::WorkerCPU worker_cpu(phase);
+        std::string_view chunk =
+            source.substr(boundaries[i], boundaries[i + 1] - boundaries[i]);
+        scanChunk(chunk, filename, static_cast<uint32_t>(boundaries[i]),
+                  chunks[i]);
+      }));
+    }
+    for (auto& job : jobs) {
+      job.get();
+    }
+  }
+
+  // Every chunk but the last ends in an EOF of its own that the serial
+  // scanner never produces
+  size_t total = 0;
+  for (const auto& chunk : chunks) {
+    total += chunk.size();
+  }
+  std::vector<LoomToken> tokens;
+  tokens.reserve(total - (chunk_count - 1));
+  for (size_t i = 0; i < chunk_count; ++i) {
+    auto end = i + 1 < chunk_count ? chunks[i].end() - 1 : chunks[i].end();
+    tokens.insert(tokens.end(), chunks[i].begin(), end);
+    std::vector<LoomToken>().swap(chunks[i]);
+  }
+
+  return tokens;
+}
+
+// Bytes the scanner may look at past the end of a token: '.', digit after
+// an integer, or 'e', sign, digit after a fraction
+static constexpr size_t kMaxScanLookahead = 3;
+
+std::vector<LoomToken> rescanEdited(std::string_view new_source,
+                                    std::string_view filename,
+                                    const std::vector<LoomToken>& old_tokens,
+                                    const SourceEdit& edit) {
+  assert(!old_tokens.empty() &&
+         old_tokens.back().type == TokenType::TOKEN_EOF);
+  assert(new_source.substr(edit.offset, edit.inserted.size()) ==
+         edit.inserted);
+  const int64_t delta = static_cast<int64_t>(edit.inserted.size()) -
+                        static_cast<int64_t>(edit.removed_length);
+  const size_t edit_end = edit.offset + edit.inserted.size();
+
+  // Restart at the last token that the edit can't have changed. The
+  // scanner carries no state from one token to the next, so scanning from
+  // the start of a token reproduces it. Error tokens don't qualify: they
+  // may start after the bytes that were scanned to produce them.
+  size_t keep = 0;
+  for (size_t i = old_tokens.size(); i-- > 0;) {
+    const LoomToken& token = old_tokens[i];
+    if (token.type != TokenType::TOKEN_ERROR &&
+        token.type != TokenType::TOKEN_EOF &&
+        token.offset + token.length + kMaxScanLookahead <= edit.offset) {
+      keep = i;
+      break;
+    }
+  }
+  std::vector<LoomToken> tokens(
+      old_tokens.begin(),
+      old_tokens.begin() + static_cast<std::ptrdiff_t>(keep));
+  tokens.reserve(old_tokens.size() + edit.inserted.size());
+
+  Scanner scanner(new_source, filename);
+  scanner.seek(keep > 0 ? old_tokens[keep].offset : 0);
+  size_t old_index = keep;
+  for (;;) {
+    LoomToken token = scanner.scanNextToken();
+    // Past the edit the text is unchanged, so a token that starts where an
+    // old one started (shifted) puts the scanner back in step with the old
+    // scan, and everything from there on is the same
+    if (token.offset >= edit_end && token.type != TokenType::TOKEN_ERROR) {
+      while (old_index < old_tokens.size() &&
+             old_tokens[old_index].offset + delta <
+                 static_cast<int64_t>(token.offset)) {
+        old_index++;
+      }
+      if (old_index < old_tokens.size() &&
+          old_tokens[old_index].offset + delta == token.offset &&
+          old_tokens[old_index].type == token.type) {
+        for (size_t i = old_index; i < old_tokens.size(); ++i) {
+          LoomToken shifted = old_tokens[i];
+          shifted.offset = static_cast<uint32_t>(shifted.offset + delta);
+          tokens.push_back(shifted);
+        }
+        break;
+      }
+    }
+    tokens.push_back(token);
+    if (token.type == TokenType::TOKEN_EOF) break;
+  }
+
+  return tokens;
 }
 
 std::string Scanner::loom_toke_type_to_string(TokenType type) {
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
-enum class TokenType {
+#include "../common/symbol.hh"
+#include "source_file.hh"
+
+enum class TokenType : uint8_t {
   TOKEN_WHITESPACE,
   TOKEN_NEWLINE,
   TOKEN_EOF,
@@ -66,30 +71,65 @@ enum class TokenType {
   TOKEN_ERROR
 };
 
-struct LoomSourceLocation {
-  std::string_view filename;
-  size_t line;
-  size_t column;
-  size_t offset;
-
-  LoomSourceLocation(std::string_view filename, size_t line = 1,
-                     size_t column = 1, size_t offset = 0)
-      : filename(filename), line(line), column(column), offset(offset) {}
+// Offsets are 32 bits wide, so a single source may not exceed 4 GiB
+constexpr size_t kMaxSourceSize = UINT32_MAX;
+// Longer tokens (in practice only string literals) are rejected
+constexpr size_t kMaxTokenLength = (size_t{1} << 24) - 1;
+
+// What a TOKEN_ERROR is about, kept on the token so it can be reported
+// wherever the token ends up; scanErrorMessage spells it out
+enum class ScanError : uint8_t {
+  TokenTooLong,
+  MisplacedDigitSeparator,
+  MissingDigitsAfterPrefix,
+  InvalidDigit,
+  IntegerTooLarge,
+  FloatOutOfRange,
+  UnterminatedString,
+  InvalidBuiltinName,
+  UnterminatedComment,
+  SingleDollar,
+  UnexpectedCharacter,
+};
 
-  std::string toString() const {
-    return "Line: " + std::to_string(line) +
-           ", Column: " + std::to_string(column);
+// A token is only a span of the source buffer, which outlives every token
+// of a compilation. Line and column are resolved from the offset through
+// the file's line table when a diagnostic needs them. Whatever the scanner
+// already worked out about the token is kept in its payload, so later
+// phases never have to look at the spelling again.
+struct LoomToken {
+  uint32_t offset;
+  uint32_t length : 24;
+  TokenType type : 8;
+  union {
+    uint64_t int_value;  // TOKEN_NUMBER_INT
+    double float_value;  // TOKEN_NUMBER_FLOAT
+    Symbol symbol;  // TOKEN_IDENTIFIER: the interned name
+    struct {
+      ScanError kind;
+      bool has_offending_char;
+      char offending_char;  // quoted after the message
+    } error;  // TOKEN_ERROR
+  };
+
+  // The scanner rejects tokens longer than kMaxTokenLength; the mask only
+  // narrows length to the bitfield
+  LoomToken(uint32_t offset = 0, uint32_t length = 0,
+            TokenType type = TokenType::TOKEN_EOF)
+      : offset(offset),
+        length(length & kMaxTokenLength),
+        type(type),
+        int_value(0) {}
+
+  std::string_view text(std::string_view source) const {
+    return source.substr(offset, length);
   }
 };
 
-struct LoomToken {
-  TokenType type;
-  LoomSourceLocation location;
-  std::string value;
+static_assert(sizeof(LoomToken) == 16, "LoomToken should stay compact");
 
-  LoomToken(TokenType type, LoomSourceLocation location, std::string value)
-      : type(type), location(location), value(value) {}
-};
+// The diagnostic for a TOKEN_ERROR, e.g. "Unexpected character: '#'"
+std::string scanErrorMessage(const LoomToken& token);
 
 class Scanner {
  private:
@@ -99,9 +139,9 @@ class Scanner {
   size_t current_offset;
   size_t start_offset;
 
-  size_t current_line;
-  size_t current_column;
-  size_t current_line_offset;
+  // Message of the last TOKEN_ERROR; the token itself only covers the
+  // offending characters
+  std::string error_message;
 
  public:
   Scanner(std::string_view source, std::string_view filename_ = "");
@@ -109,6 +149,12 @@ class Scanner {
   // Scans and returns the next token of the source
   LoomToken scanNextToken();
 
+  const std::string& getLastError() const { return error_message; }
+  std::string_view getSource() const { return source_buffer; }
+
+  // Continues scanning at offset, which has to be the start of a token
+  void seek(size_t offset) { current_offset = offset; }
+
   // i guess that would be helpful for debugging
   std::string loom_toke_type_to_string(TokenType type);
 
@@ -123,11 +169,47 @@ class Scanner {
   LoomToken scanMultiLineComment();
   bool match(char expected);
 
-  LoomSourceLocation getCurrentLocation();
   LoomToken makeToken(TokenType type);
-  LoomToken makeErrorToken(const std::string &message, char offending_char);
+  LoomToken makeErrorToken(ScanError kind, char offending_char);
+  // Error spanning the whole token scanned so far
+  LoomToken makeErrorToken(ScanError kind);
   LoomToken scanNumber();
+  LoomToken scanFloat();
   LoomToken scanIdentifier();
   LoomToken scanString();
   LoomToken scanBuiltin();
 };
+
+// Sources at least this large are scanned by scanParallel
+constexpr size_t kParallelScanThreshold = size_t{8} << 20;
+
+// Offsets at which source can be cut into chunks of roughly chunk_size bytes
+// that scan independently: each is just after a newline that the scanner
+// would reach outside of a string or """ comment. Always starts with 0.
+std::vector<size_t> findChunkBoundaries(std::string_view source,
+                                        size_t chunk_size);
+
+// Scans the whole source on up to thread_count threads (0: one per core)
+// and returns its tokens, ending with TOKEN_EOF. The result is the same as
+// calling Scanner::scanNextToken until EOF.
+std::vector<LoomToken> scanParallel(std::string_view source,
+                                    std::string_view filename,
+                                    unsigned thread_count = 0);
+
+// removed_length bytes at offset replaced by inserted
+struct SourceEdit {
+  size_t offset;
+  size_t removed_length;
+  std::string_view inserted;
+};
+
+// Tokens of new_source, the source old_tokens were scanned from with edit
+// applied. Only the part around the edit is scanned again: old tokens in
+// front of it are kept, and once the scanner reaches a token start that
+// also existed before the edit, the remaining old tokens are reused with
+// shifted offsets. An edit that opens or closes a string or """ comment
+// simply keeps the scan going until the two agree again.
+std::vector<LoomToken> rescanEdited(std::string_view new_source,
+                                    std::string_view filename,
+                                    const std::vector<LoomToken>& old_tokens,
+                                    const SourceEdit& edit);
@@ -0,0 +1,50 @@
+// compiler/scanner/source_file.cc
+#include "source_file.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include "llvm/Support/MemoryBuffer.h"
+
+LoomSourceFile::LoomSourceFile(std::unique_ptr<llvm::MemoryBuffer> buffer,
+                               uint32_t start_location)
+    : buffer(std::move(buffer)),
+      filename(this->buffer->getBufferIdentifier()),
+      text(this->buffer->getBuffer()),
+      start_location(start_location) {}
+
+LoomSourceFile::~LoomSourceFile() = default;
+
+const std::vector<uint32_t>& LoomSourceFile::lineStarts() const {
+  // Diagnostics of one file may be resolved from several threads
+  std::call_once(line_starts_built, [this]() {
+    line_starts.push_back(0);
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    // memchr is vectorized by the C library, unlike a byte-wise loop
+    for (const char* p = begin; p < end;) {
+      const void* newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+      if (!newline) break;
+      p = static_cast<const char*>(newline) + 1;
+      line_starts.push_back(static_cast<uint32_t>(p - begin));
+    }
+  });
+  return line_starts;
+}
+
+size_t LoomSourceFile::getLine(uint32_t offset) const {
+  // The line containing offset is the last one starting at or before it
+  const std::vector<uint32_t>& starts = lineStarts();
+  return static_cast<size_t>(
+      std::upper_bound(starts.begin(), starts.end(), offset) -
+      starts.begin());
+}
+
+size_t LoomSourceFile::getColumn(uint32_t offset) const {
+  return offset - lineStarts()[getLine(offset) - 1] + 1;
+}
+
+std::string LoomSourceFile::describe(uint32_t offset) const {
+  return "Line: " + std::to_string(getLine(offset)) +
+         ", Column: " + std::to_string(getColumn(offset));
+}
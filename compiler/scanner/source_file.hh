@@ -0,0 +1,60 @@
+// compiler/scanner/source_file.hh
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+// A loaded source buffer and the offsets at which its lines start. The
+// table is built with one memchr pass, so the scanner doesn't have to track
+// line and column per character; both are found by binary search when a
+// diagnostic needs them. Files are owned by the SourceManager.
+class LoomSourceFile {
+ public:
+  // The buffer's identifier is used as the filename. start_location is
+  // where the file's range begins in the SourceManager's location space.
+  LoomSourceFile(std::unique_ptr<llvm::MemoryBuffer> buffer,
+                 uint32_t start_location);
+  ~LoomSourceFile();
+
+  LoomSourceFile(const LoomSourceFile&) = delete;
+  LoomSourceFile& operator=(const LoomSourceFile&) = delete;
+
+  std::string_view getFilename() const { return filename; }
+  std::string_view getText() const { return text; }
+  uint32_t getStartLocation() const { return start_location; }
+
+  // 1-based line and column of a byte offset
+  size_t getLine(uint32_t offset) const;
+  size_t getColumn(uint32_t offset) const;
+  // "Line: X, Column: Y", as diagnostics print it
+  std::string describe(uint32_t offset) const;
+
+ private:
+  std::unique_ptr<llvm::MemoryBuffer> buffer;  // usually a file mapping
+  std::string_view filename;
+  std::string_view text;
+  uint32_t start_location;
+  // Only built once a location is resolved; most files never need it
+  mutable std::once_flag line_starts_built;
+  mutable std::vector<uint32_t> line_starts;  // sorted, line_starts[0] == 0
+
+  const std::vector<uint32_t>& lineStarts() const;
+};
+
+// Position of a token or AST node, kept to 32 bits so it can be embedded
+// in every node. The SourceManager lays all files out back to back in one
+// location space (each from its getStartLocation() up to and including its
+// end-of-file position), so the offset alone identifies the file. Line and
+// column are only computed when the location is printed, through
+// SourceManager::describe().
+struct LoomSourceLocation {
+  uint32_t offset = 0;
+};
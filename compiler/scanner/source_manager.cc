@@ -0,0 +1,62 @@
+// compiler/scanner/source_manager.cc
+#include "source_manager.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#include "../common/logger.hh"
+#include "llvm/Support/MemoryBuffer.h"
+
+const LoomSourceFile* SourceManager::loadFile(const std::string& path) {
+  // The scanner checks bounds itself, so the buffer needs no terminating
+  // null. That lets LLVM map files whose size is a multiple of the page
+  // size too, instead of falling back to reading them into the heap.
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer) {
+    LOOM_ERROR("Could not open file '", path,
+               "': ", buffer.getError().message());
+    return nullptr;
+  }
+  return addFile(std::move(*buffer));
+}
+
+const LoomSourceFile* SourceManager::addBuffer(std::string_view name,
+                                               std::string_view text) {
+  return addFile(llvm::MemoryBuffer::getMemBufferCopy(
+      llvm::StringRef(text.data(), text.size()),
+      llvm::StringRef(name.data(), name.size())));
+}
+
+const LoomSourceFile* SourceManager::addFile(
+    std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  // One extra position per file for its EOF token, so that doesn't share a
+  // location with the first byte of the next file
+  uint64_t end_location = next_start_location + buffer->getBufferSize() + 1;
+  if (end_location > uint64_t{UINT32_MAX} + 1) {
+    LOOM_ERROR("Sources of '", buffer->getBufferIdentifier().str(),
+               "' and the files before it exceed 4 GiB in total");
+    return nullptr;
+  }
+  files.push_back(std::make_unique<LoomSourceFile>(
+      std::move(buffer), static_cast<uint32_t>(next_start_location)));
+  next_start_location = end_location;
+  return files.back().get();
+}
+
+const LoomSourceFile& SourceManager::getFile(LoomSourceLocation loc) const {
+  // The file is the last one starting at or before the location
+  auto next = std::upper_bound(
+      files.begin(), files.end(), loc.offset,
+      [](uint32_t offset, const std::unique_ptr<LoomSourceFile>& file) {
+        return offset < file->getStartLocation();
+      });
+  assert(next != files.begin() && "location outside every file");
+  return **(next - 1);
+}
+
+std::string SourceManager::describe(LoomSourceLocation loc) const {
+  const LoomSourceFile& file = getFile(loc);
+  return file.describe(loc.offset - file.getStartLocation());
+}
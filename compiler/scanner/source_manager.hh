@@ -0,0 +1,47 @@
+// compiler/scanner/source_manager.hh
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "source_file.hh"
+
+// Owns every source file of a compilation. llvm::MemoryBuffer maps files
+// (only small ones are read into the heap), so the scanner works on the
+// mapped bytes without a copy. Tokens, AST nodes and locations point into
+// these buffers, so the manager has to outlive all of them.
+class SourceManager {
+ public:
+  SourceManager() = default;
+
+  SourceManager(const SourceManager&) = delete;
+  SourceManager& operator=(const SourceManager&) = delete;
+
+  // Maps the file at path. Returns null (and logs why) if it can't be read.
+  const LoomSourceFile* loadFile(const std::string& path);
+
+  // Adds a copy of an in-memory source, e.g. the built-in test program
+  const LoomSourceFile* addBuffer(std::string_view name,
+                                  std::string_view text);
+
+  const std::vector<std::unique_ptr<LoomSourceFile>>& getFiles() const {
+    return files;
+  }
+
+  // The file a location points into
+  const LoomSourceFile& getFile(LoomSourceLocation loc) const;
+
+  // "Line: X, Column: Y" of a location, as diagnostics print it
+  std::string describe(LoomSourceLocation loc) const;
+
+ private:
+  // Sorted by start location, since files are laid out in load order
+  std::vector<std::unique_ptr<LoomSourceFile>> files;
+  // Where the next file's range starts; 64 bits to detect running past the
+  // 32-bit location space
+  uint64_t next_start_location = 0;
+
+  const LoomSourceFile* addFile(std::unique_ptr<llvm::MemoryBuffer> buffer);
+};
@@ -0,0 +1,57 @@
+// compiler/scanner/token_stream.cc
+#include "token_stream.hh"
+
+#include <cassert>
+
+const LoomToken& TokenStream::peek(size_t ahead) {
+  assert(ahead <= kMaxLookahead);
+  while (count <= ahead) {
+    fill();
+  }
+  return ring[(head + ahead) & (kCapacity - 1)];
+}
+
+LoomToken TokenStream::next() {
+  LoomToken token = peek();
+  // The EOF token stays put, so the parser can keep asking for it
+  if (token.type != TokenType::TOKEN_EOF) {
+    head = (head + 1) & (kCapacity - 1);
+    --count;
+  }
+  return token;
+}
+
+void TokenStream::fill() {
+  size_t slot = (head + count) & (kCapacity - 1);
+  if (scanned_eof) {
+    // Past the end: repeat the EOF token instead of scanning again
+    ring[slot] = ring[(slot - 1) & (kCapacity - 1)];
+    ++count;
+    return;
+  }
+
+  LoomToken token;
+  if (scanner) {
+    token = scanner->scanNextToken();
+  } else if (scanned_pos < scanned.size()) {
+    token = scanned[scanned_pos++];
+  } else {
+    // End of a range that doesn't contain the EOF token
+    uint32_t end = 0;
+    if (!scanned.empty()) {
+      end = scanned.back().offset + scanned.back().length;
+    }
+    token = LoomToken(end, 0, TokenType::TOKEN_EOF);
+  }
+  if (trace) {
+    *trace << "Scanned: " << scanner->loom_toke_type_to_string(token.type)
+           << " ('" << token.text(scanner->getSource()) << "')";
+    if (token.type == TokenType::TOKEN_ERROR) {
+      *trace << " " << scanner->getLastError();
+    }
+    *trace << std::endl;
+  }
+  scanned_eof = token.type == TokenType::TOKEN_EOF;
+  ring[slot] = token;
+  ++count;
+}
@@ -0,0 +1,60 @@
+// compiler/scanner/token_stream.hh
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "scanner_internal.hh"
+
+// Hands the scanner's tokens to the parser on demand. Only the few tokens
+// the parser can still look at are kept, in a fixed ring, so a file is
+// never materialized as a token vector and scanning runs interleaved with
+// parsing. Huge files are the exception: scanParallel lexes them up front,
+// and the stream then hands out the finished tokens, or a range of them.
+class TokenStream {
+ public:
+  // Tokens the parser may look ahead of the current one
+  static constexpr size_t kMaxLookahead = 3;
+
+  explicit TokenStream(Scanner& scanner, std::ostream* trace = nullptr)
+      : scanner(&scanner), trace(trace) {}
+  // Tokens scanned beforehand, ending with TOKEN_EOF
+  explicit TokenStream(std::vector<LoomToken> tokens)
+      : owned(std::move(tokens)), scanned(owned) {}
+  // A range of tokens scanned beforehand, which the stream doesn't own. It
+  // ends with TOKEN_EOF, or else an EOF token just past its last token is
+  // appended.
+  explicit TokenStream(std::span<const LoomToken> scanned)
+      : scanned(scanned) {}
+
+  TokenStream(const TokenStream&) = delete;
+  TokenStream& operator=(const TokenStream&) = delete;
+
+  // The token ahead tokens past the current one. The reference stays valid
+  // until the next call to next().
+  const LoomToken& peek(size_t ahead = 0);
+
+  // Consumes and returns the current token. Once the end is reached every
+  // further call returns the EOF token again.
+  LoomToken next();
+
+ private:
+  static constexpr size_t kCapacity = 4;  // power of two, > kMaxLookahead
+  static_assert((kCapacity & (kCapacity - 1)) == 0 &&
+                kCapacity > kMaxLookahead);
+
+  Scanner* scanner = nullptr;  // null when reading from scanned
+  std::ostream* trace = nullptr;  // "Scanned:" log, null unless debugging
+  std::vector<LoomToken> owned;  // backs scanned if the stream owns it
+  std::span<const LoomToken> scanned;
+  size_t scanned_pos = 0;
+  std::array<LoomToken, kCapacity> ring;
+  size_t head = 0;   // slot of the current token
+  size_t count = 0;  // buffered tokens starting at head
+  bool scanned_eof = false;
+
+  void fill();
+};
@@ -4,15 +4,29 @@
 #include <iostream>
 #include <string>
 
+#include "../common/logger.hh"
+#include "llvm/Support/TimeProfiler.h"
+
+// Names the analyzer treats specially
+static const Symbol null_symbol = Symbol::intern("null");
+static const Symbol print_symbol = Symbol::intern("print");
+
 // --- Konstruktor und Hauptfunktionen ---
 
-SemanticAnalyzer::SemanticAnalyzer() : had_error(false) {
+SemanticAnalyzer::SemanticAnalyzer(Arena& arena, const SourceManager& sources)
+    : arena(arena), sources(sources), had_error(false) {
   // Der Konstruktor der SymbolTable wird automatisch aufgerufen
   // und erstellt den globalen Scope für uns.
 }
 
-void SemanticAnalyzer::analyze(
-    const std::vector<std::unique_ptr<StmtNode>>& ast) {
+void SemanticAnalyzer::analyze(const std::vector<StmtNode*>& ast) {
+  // Declaration pass: make every top-level function visible to all bodies
+  for (const auto& stmt : ast) {
+    if (auto* func_decl = dyn_cast<FunctionDeclNode>(stmt)) {
+      declared_functions[func_decl] = declareFunction(*func_decl);
+    }
+  }
+
   for (const auto& stmt : ast) {
     if (stmt) {
       stmt->accept(*this);
@@ -23,16 +37,16 @@ void SemanticAnalyzer::analyze(
 void SemanticAnalyzer::error(const LoomSourceLocation& loc,
                              const std::string& message) {
   had_error = true;
-  std::cerr << "Semantic Error at " << loc.toString() << ": " << message
-            << std::endl;
+  std::cerr << "Semantic Error at " << sources.describe(loc) << ": "
+            << message << std::endl;
 }
 
 // --- visit-Methoden für Statements (geben void zurück) ---
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(VarDeclNode& node) {
+TypeNode* SemanticAnalyzer::visit(VarDeclNode& node) {
   // Schritt 1: Analysiere den Initializer zuerst (falls vorhanden) und hole
   // seinen Typ.
-  std::unique_ptr<TypeNode> initializer_type = nullptr;
+  TypeNode* initializer_type = nullptr;
   if (node.initializer) {
     // Rufe die `accept`-Methode auf, die einen SemaVisitor akzeptiert und einen
     // Typ zurückgibt.
@@ -51,25 +65,23 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(VarDeclNode& node) {
     // Check for memory model type compatibility
     bool types_compatible = false;
 
-    if (node.type->isEqualTo(initializer_type.get())) {
+    if (node.type->isEqualTo(initializer_type)) {
       // Types are exactly equal
       types_compatible = true;
-    } else if (node.type->canAcceptFrom(initializer_type.get())) {
+    } else if (node.type->canAcceptFrom(initializer_type)) {
       // Use the new canAcceptFrom method for memory model compatibility
       types_compatible = true;
     } else {
       // Check for literal conversion (legacy compatibility)
-      if (auto int_literal = dynamic_cast<const IntegerLiteralTypeNode*>(
-              initializer_type.get())) {
-        if (auto target_int =
-                dynamic_cast<const IntegerTypeNode*>(node.type.get())) {
+      if (auto int_literal = dyn_cast<IntegerLiteralTypeNode>(
+              initializer_type)) {
+        if (auto target_int = dyn_cast<IntegerTypeNode>(node.type)) {
           // Check if integer literal can fit into target integer type
           types_compatible = int_literal->canFitInto(target_int);
         }
-      } else if (auto float_literal = dynamic_cast<const FloatLiteralTypeNode*>(
-                     initializer_type.get())) {
-        if (auto target_float =
-                dynamic_cast<const FloatTypeNode*>(node.type.get())) {
+      } else if (auto float_literal = dyn_cast<FloatLiteralTypeNode>(
+                     initializer_type)) {
+        if (auto target_float = dyn_cast<FloatTypeNode>(node.type)) {
           // Check if float literal can fit into target float type
           types_compatible = float_literal->canFitInto(target_float);
         }
@@ -83,12 +95,12 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(VarDeclNode& node) {
           initializer_type->getTypeName() + "'";
 
       // Add helpful info for literal conversions
-      if (auto int_literal = dynamic_cast<const IntegerLiteralTypeNode*>(
-              initializer_type.get())) {
+      if (auto int_literal = dyn_cast<IntegerLiteralTypeNode>(
+              initializer_type)) {
         error_msg +=
             " (value " + std::to_string(int_literal->value) + " doesn't fit)";
-      } else if (auto float_literal = dynamic_cast<const FloatLiteralTypeNode*>(
-                     initializer_type.get())) {
+      } else if (auto float_literal = dyn_cast<FloatLiteralTypeNode>(
+                     initializer_type)) {
         error_msg +=
             " (value " + std::to_string(float_literal->value) + " doesn't fit)";
       }
@@ -98,7 +110,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(VarDeclNode& node) {
   }
 
   // Schritt 4: Bestimme den finalen Typ der Variable und speichere ihn.
-  std::unique_ptr<TypeNode> final_type = nullptr;
+  TypeNode* final_type = nullptr;
   if (node.type) {
     // Wenn ein Typ explizit angegeben wurde, nehmen wir den.
     // Wir müssen eine Kopie erstellen, da der `node.type` unique ist.
@@ -108,24 +120,22 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(VarDeclNode& node) {
     // Ansonsten inferieren (schlussfolgern) wir den Typ vom Initializer
     // UND LÖSEN IHN SOFORT IN EINEN KONKRETEN TYP AUF.
 
-    if (auto* lit =
-            dynamic_cast<IntegerLiteralTypeNode*>(initializer_type.get())) {
+    if (auto* lit = dyn_cast<IntegerLiteralTypeNode>(initializer_type)) {
       // Standard-Inferenz: Ein Integer-Literal ohne Kontext wird zu i32.
-      final_type = std::make_unique<IntegerTypeNode>(lit->location, 32, true);
-    } else if (auto* lit = dynamic_cast<FloatLiteralTypeNode*>(
-                   initializer_type.get())) {
+      final_type = arena.create<IntegerTypeNode>(lit->location, 32, true);
+    } else if (auto* lit = dyn_cast<FloatLiteralTypeNode>(initializer_type)) {
       // Standard-Inferenz: Ein Float-Literal ohne Kontext wird zu f64.
-      final_type = std::make_unique<FloatTypeNode>(lit->location, 64);
+      final_type = arena.create<FloatTypeNode>(lit->location, 64);
     } else {
       // Andere Typen (wie string) sind bereits konkret und können übernommen
       // werden.
-      final_type = std::move(initializer_type);
+      final_type = initializer_type;
     }
 
   } else {
     // Fall C: Kein Typ und kein Initializer. Das ist ein Fehler in unserer
     // Sprache.
-    error(node.location, "Cannot infer type for variable '" + node.name +
+    error(node.location, "Cannot infer type for variable '" + node.name.str() +
                              "' without an explicit type or an initializer.");
     return nullptr;  // Beende die Analyse für diese fehlerhafte Deklaration.
   }
@@ -133,38 +143,35 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(VarDeclNode& node) {
   // set
   if (!node.type && final_type) {
     // Create a copy of the final_type for the node
-    if (auto int_literal =
-            dynamic_cast<IntegerLiteralTypeNode*>(final_type.get())) {
-      node.type = std::make_unique<IntegerLiteralTypeNode>(
-          int_literal->location, int_literal->value);
+    if (auto int_literal = dyn_cast<IntegerLiteralTypeNode>(final_type)) {
+      node.type = arena.create<IntegerLiteralTypeNode>(int_literal->location,
+                                                       int_literal->value);
     } else if (auto float_literal =
-                   dynamic_cast<FloatLiteralTypeNode*>(final_type.get())) {
-      node.type = std::make_unique<FloatLiteralTypeNode>(
-          float_literal->location, float_literal->value);
-    } else if (auto int_type =
-                   dynamic_cast<IntegerTypeNode*>(final_type.get())) {
-      node.type = std::make_unique<IntegerTypeNode>(
+                   dyn_cast<FloatLiteralTypeNode>(final_type)) {
+      node.type = arena.create<FloatLiteralTypeNode>(float_literal->location,
+                                                     float_literal->value);
+    } else if (auto int_type = dyn_cast<IntegerTypeNode>(final_type)) {
+      node.type = arena.create<IntegerTypeNode>(
           int_type->location, int_type->bit_width, int_type->is_signed);
-    } else if (auto float_type =
-                   dynamic_cast<FloatTypeNode*>(final_type.get())) {
-      node.type = std::make_unique<FloatTypeNode>(float_type->location,
-                                                  float_type->bit_width);
-    } else if (auto string_type =
-                   dynamic_cast<StringTypeNode*>(final_type.get())) {
-      node.type = std::make_unique<StringTypeNode>(string_type->location);
+    } else if (auto float_type = dyn_cast<FloatTypeNode>(final_type)) {
+      node.type = arena.create<FloatTypeNode>(float_type->location,
+                                              float_type->bit_width);
+    } else if (auto string_type = dyn_cast<StringTypeNode>(final_type)) {
+      node.type = arena.create<StringTypeNode>(string_type->location);
     }
     // Add other type cases as needed
   }
 
   // Schritt 6: Definiere die Variable in der Symboltabelle.
-  if (!symbols.defineVariable(node.name, node.kind, std::move(final_type))) {
+  if (!symbols.defineVariable(node.name, node.kind, final_type)) {
     error(node.location,
-          "Variable '" + node.name + "' is already declared in this scope.");
+          "Variable '" + node.name.str() +
+              "' is already declared in this scope.");
   }
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(ExprStmtNode& node) {
+TypeNode* SemanticAnalyzer::visit(ExprStmtNode& node) {
   if (node.expression) {
     // Wir rufen accept auf, aber ignorieren den zurückgegebenen Typ,
     // da das Ergebnis des Ausdrucks nicht verwendet wird.
@@ -173,7 +180,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(ExprStmtNode& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(TypeNode& /* node */) {
+TypeNode* SemanticAnalyzer::visit(TypeNode& /* node */) {
   // Vorerst nichts zu tun. Später könnten wir hier prüfen,
   // ob der Typname (z.B. "i32") ein gültiger, bekannter Typ ist.
   return nullptr;
@@ -181,41 +188,38 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(TypeNode& /* node */) {
 
 // --- visit-Methoden für Expressions (geben einen Typ zurück) ---
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(NumberLiteral& node) {
+TypeNode* SemanticAnalyzer::visit(NumberLiteral& node) {
+  // The scanner already decoded the value
   if (node.is_float) {
-    // Parse the float value and create a FloatLiteralTypeNode
-    double value = std::stod(node.value);
-    return std::make_unique<FloatLiteralTypeNode>(node.location, value);
+    return arena.create<FloatLiteralTypeNode>(node.location, node.float_value);
   } else {
-    // Parse the integer value and create an IntegerLiteralTypeNode
-    long long value = std::stoll(node.value);
-    return std::make_unique<IntegerLiteralTypeNode>(node.location, value);
+    return arena.create<IntegerLiteralTypeNode>(node.location, node.int_value);
   }
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(BooleanLiteral& node) {
-  return std::make_unique<BooleanTypeNode>(node.location);
+TypeNode* SemanticAnalyzer::visit(BooleanLiteral& node) {
+  return arena.create<BooleanTypeNode>(node.location);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(StringLiteral& node) {
-  return std::make_unique<StringTypeNode>(node.location);
+TypeNode* SemanticAnalyzer::visit(StringLiteral& node) {
+  return arena.create<StringTypeNode>(node.location);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(Identifier& node) {
+TypeNode* SemanticAnalyzer::visit(Identifier& node) {
   // Handle special null literal
-  if (node.name == "null") {
-    return std::make_unique<NullTypeNode>(node.location);
+  if (node.name == null_symbol) {
+    return arena.create<NullTypeNode>(node.location);
   }
 
   const SymbolInfo* info = symbols.lookup(node.name);
   if (info == nullptr) {
-    error(node.location, "Undeclared identifier '" + node.name + "'.");
+    error(node.location, "Undeclared identifier '" + node.name.str() + "'.");
     return nullptr;
   }
 
   // Get the variable info from the symbol data
   if (info->kind != SymbolKind::VARIABLE) {
-    error(node.location, "'" + node.name + "' is not a variable.");
+    error(node.location, "'" + node.name.str() + "' is not a variable.");
     return nullptr;
   }
 
@@ -223,19 +227,19 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(Identifier& node) {
   return var_info.type->accept(*this);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(AssignmentExpr& node) {
-  std::unique_ptr<TypeNode> value_type = node.value->accept(*this);
+TypeNode* SemanticAnalyzer::visit(AssignmentExpr& node) {
+  TypeNode* value_type = node.value->accept(*this);
   if (!value_type) return nullptr;
 
   const SymbolInfo* info = symbols.lookup(node.name);
 
   if (info == nullptr) {
-    error(node.location, "Undeclared identifier '" + node.name + "'.");
+    error(node.location, "Undeclared identifier '" + node.name.str() + "'.");
     return nullptr;
   }
   // Get the variable info from the symbol
   if (info->kind != SymbolKind::VARIABLE) {
-    error(node.location, "'" + node.name + "' is not a variable.");
+    error(node.location, "'" + node.name.str() + "' is not a variable.");
     return nullptr;
   }
 
@@ -243,27 +247,24 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(AssignmentExpr& node) {
 
   if (var_info.kind != VarDeclKind::MUT) {
     error(node.location,
-          "Cannot assign to immutable variable '" + node.name + "'.");
+          "Cannot assign to immutable variable '" + node.name.str() + "'.");
     return nullptr;
   }
 
   // Check type compatibility with literal conversion support
   bool types_compatible = false;
 
-  if (var_info.type->isEqualTo(value_type.get())) {
+  if (var_info.type->isEqualTo(value_type)) {
     types_compatible = true;
   } else {
     // Check for literal conversion
-    if (auto int_literal =
-            dynamic_cast<const IntegerLiteralTypeNode*>(value_type.get())) {
-      if (auto target_int =
-              dynamic_cast<const IntegerTypeNode*>(var_info.type.get())) {
+    if (auto int_literal = dyn_cast<IntegerLiteralTypeNode>(value_type)) {
+      if (auto target_int = dyn_cast<IntegerTypeNode>(var_info.type)) {
         types_compatible = int_literal->canFitInto(target_int);
       }
-    } else if (auto float_literal = dynamic_cast<const FloatLiteralTypeNode*>(
-                   value_type.get())) {
-      if (auto target_float =
-              dynamic_cast<const FloatTypeNode*>(var_info.type.get())) {
+    } else if (auto float_literal = dyn_cast<FloatLiteralTypeNode>(
+                   value_type)) {
+      if (auto target_float = dyn_cast<FloatTypeNode>(var_info.type)) {
         types_compatible = float_literal->canFitInto(target_float);
       }
     }
@@ -272,7 +273,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(AssignmentExpr& node) {
   if (!types_compatible) {
     error(node.location, "Type mismatch: Cannot assign value of type '" +
                              value_type->getTypeName() + "' to variable '" +
-                             node.name + "' of type '" +
+                             node.name.str() + "' of type '" +
                              var_info.type->getTypeName() + "'.");
     return nullptr;
   }
@@ -281,59 +282,55 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(AssignmentExpr& node) {
   return value_type;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(UnaryExpr& node) {
-  std::unique_ptr<TypeNode> right_type = node.right->accept(*this);
+TypeNode* SemanticAnalyzer::visit(UnaryExpr& node) {
+  TypeNode* right_type = node.right->accept(*this);
   if (!right_type) return nullptr;
-  switch (node.op.type) {
+  switch (node.op) {
     case TokenType::TOKEN_BANG:
       // Logical NOT operator always returns bool
-      return std::make_unique<BooleanTypeNode>(node.location);
+      return arena.create<BooleanTypeNode>(node.location);
 
     case TokenType::TOKEN_MINUS:
       // Check if the type supports unary minus (integers and floats)
-      if (dynamic_cast<const IntegerTypeNode*>(right_type.get()) ||
-          dynamic_cast<const FloatTypeNode*>(right_type.get())) {
+      if (isa<IntegerTypeNode>(right_type) || isa<FloatTypeNode>(right_type)) {
         // Return the same type as the operand
         return right_type->accept(*this);
       } else {
-        error(node.op.location, "Operator '-' cannot be applied to type '" +
-                                    right_type->getTypeName() + "'.");
+        error(node.location, "Operator '-' cannot be applied to type '" +
+                                 right_type->getTypeName() + "'.");
         return nullptr;
       }
 
     default:
-      error(node.op.location, "Unknown unary operator.");
+      error(node.location, "Unknown unary operator.");
       return nullptr;
   }
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(BinaryExpr& node) {
-  std::unique_ptr<TypeNode> left_type = node.left->accept(*this);
-  std::unique_ptr<TypeNode> right_type = node.right->accept(*this);
+TypeNode* SemanticAnalyzer::visit(BinaryExpr& node) {
+  TypeNode* left_type = node.left->accept(*this);
+  TypeNode* right_type = node.right->accept(*this);
   if (!left_type || !right_type) return nullptr;
 
   // Check if the types are compatible for binary operations
   // Special handling for integer literal to integer type compatibility
   bool types_compatible = false;
-  std::unique_ptr<TypeNode> result_type = nullptr;
+  TypeNode* result_type = nullptr;
 
-  if (left_type->isEqualTo(right_type.get())) {
+  if (left_type->isEqualTo(right_type)) {
     // Types are exactly equal
     types_compatible = true;
     result_type = left_type->accept(*this);
   } else {
     // Check for integer literal compatibility
-    auto* left_int_literal =
-        dynamic_cast<IntegerLiteralTypeNode*>(left_type.get());
-    auto* right_int_literal =
-        dynamic_cast<IntegerLiteralTypeNode*>(right_type.get());
-    auto* left_int_type = dynamic_cast<IntegerTypeNode*>(left_type.get());
-    auto* right_int_type = dynamic_cast<IntegerTypeNode*>(right_type.get());
+    auto* left_int_literal = dyn_cast<IntegerLiteralTypeNode>(left_type);
+    auto* right_int_literal = dyn_cast<IntegerLiteralTypeNode>(right_type);
+    auto* left_int_type = dyn_cast<IntegerTypeNode>(left_type);
+    auto* right_int_type = dyn_cast<IntegerTypeNode>(right_type);
     if (left_int_literal && right_int_literal) {
       // Both are literals - treat as compatible and return i32 type
       types_compatible = true;
-      result_type =
-          std::make_unique<IntegerTypeNode>(node.op.location, 32, true);
+      result_type = arena.create<IntegerTypeNode>(node.op_location, 32, true);
     } else if (left_int_literal && right_int_type) {
       // Left is literal, right is concrete type - use right type
       types_compatible = true;
@@ -346,65 +343,70 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(BinaryExpr& node) {
   }
 
   if (!types_compatible) {
-    error(node.op.location, "Type mismatch for operator '" + node.op.value +
-                                "': '" + left_type->getTypeName() + "' and '" +
+    error(node.op_location, std::string("Type mismatch for operator '") +
+                                operatorSpelling(node.op) + "': '" +
+                                left_type->getTypeName() + "' and '" +
                                 right_type->getTypeName() + "'.");
     return nullptr;
   }
 
-  // For comparison operators (==, !=, <, >, <=, >=), return boolean type
-  if (node.op.value == "==" || node.op.value == "!=" || node.op.value == "<" ||
-      node.op.value == ">" || node.op.value == "<=" || node.op.value == ">=") {
-    return std::make_unique<BooleanTypeNode>(node.op.location);
+  // For comparison operators (==, <, >, <=, >=), return boolean type
+  switch (node.op) {
+    case TokenType::TOKEN_EQUAL_EQUAL:
+    case TokenType::TOKEN_LESS:
+    case TokenType::TOKEN_GREATER:
+    case TokenType::TOKEN_LESS_EQUAL:
+    case TokenType::TOKEN_GREATER_EQUAL:
+      return arena.create<BooleanTypeNode>(node.op_location);
+    default:
+      break;
   }
 
   // For other operators, return the result type
   return result_type;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(IntegerTypeNode& node) {
+TypeNode* SemanticAnalyzer::visit(IntegerTypeNode& node) {
   // Create a copy of the integer type
-  return std::make_unique<IntegerTypeNode>(node.location, node.bit_width,
-                                           node.is_signed);
+  return arena.create<IntegerTypeNode>(node.location, node.bit_width,
+                                       node.is_signed);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(FloatTypeNode& node) {
+TypeNode* SemanticAnalyzer::visit(FloatTypeNode& node) {
   // Create a copy of the float type
-  return std::make_unique<FloatTypeNode>(node.location, node.bit_width);
+  return arena.create<FloatTypeNode>(node.location, node.bit_width);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(BooleanTypeNode& node) {
+TypeNode* SemanticAnalyzer::visit(BooleanTypeNode& node) {
   // Create a copy of the boolean type
-  return std::make_unique<BooleanTypeNode>(node.location);
+  return arena.create<BooleanTypeNode>(node.location);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(StringTypeNode& node) {
+TypeNode* SemanticAnalyzer::visit(StringTypeNode& node) {
   // Create a copy of the string type
-  return std::make_unique<StringTypeNode>(node.location);
+  return arena.create<StringTypeNode>(node.location);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(NullTypeNode& node) {
+TypeNode* SemanticAnalyzer::visit(NullTypeNode& node) {
   // Create a copy of the null type
-  return std::make_unique<NullTypeNode>(node.location);
+  return arena.create<NullTypeNode>(node.location);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(
-    IntegerLiteralTypeNode& node) {
+TypeNode* SemanticAnalyzer::visit(IntegerLiteralTypeNode& node) {
   // Create a copy of the integer literal type
-  return std::make_unique<IntegerLiteralTypeNode>(node.location, node.value);
+  return arena.create<IntegerLiteralTypeNode>(node.location, node.value);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(FloatLiteralTypeNode& node) {
+TypeNode* SemanticAnalyzer::visit(FloatLiteralTypeNode& node) {
   // Create a copy of the float literal type
-  return std::make_unique<FloatLiteralTypeNode>(node.location, node.value);
+  return arena.create<FloatLiteralTypeNode>(node.location, node.value);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(IfStmtNode& node) {
+TypeNode* SemanticAnalyzer::visit(IfStmtNode& node) {
   // Analyze the condition - it must be boolean
   if (node.condition) {
-    std::unique_ptr<TypeNode> condition_type = node.condition->accept(*this);
-    if (condition_type &&
-        !dynamic_cast<BooleanTypeNode*>(condition_type.get())) {
+    TypeNode* condition_type = node.condition->accept(*this);
+    if (condition_type && !isa<BooleanTypeNode>(condition_type)) {
       error(node.location, "If condition must be boolean type.");
     }
   }
@@ -426,11 +428,10 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(IfStmtNode& node) {
   return nullptr;  // If statements don't return a value
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(WhileStmtNode& node) {
+TypeNode* SemanticAnalyzer::visit(WhileStmtNode& node) {
   if (node.condition) {
-    std::unique_ptr<TypeNode> condition_type = node.condition->accept(*this);
-    if (condition_type &&
-        !dynamic_cast<BooleanTypeNode*>(condition_type.get())) {
+    TypeNode* condition_type = node.condition->accept(*this);
+    if (condition_type && !isa<BooleanTypeNode>(condition_type)) {
       error(node.location, "While condition must be boolean type.");
     }
   }
@@ -443,9 +444,9 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(WhileStmtNode& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(
+TypeNode* SemanticAnalyzer::visit(
     FunctionCallExpr& node) {  // Check for built-in functions first
-  if (node.function_name == "print") {
+  if (node.function_name == print_symbol) {
     // Print function expects exactly one argument
     if (node.arguments.size() != 1) {
       error(node.location, "print() function expects exactly one argument.");
@@ -454,7 +455,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(
 
     // Analyze the argument type
     if (node.arguments[0]) {
-      std::unique_ptr<TypeNode> arg_type = node.arguments[0]->accept(*this);
+      node.arguments[0]->accept(*this);
       // print can accept any type, so we don't need to check it
     }
 
@@ -465,16 +466,16 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(
   // Check for user-defined functions
   const FunctionInfo* func_info = symbols.lookupFunction(node.function_name);
   if (!func_info) {
-    error(node.location, "Unknown function: " + node.function_name);
+    error(node.location, "Unknown function: " + node.function_name.str());
     return nullptr;
   }
 
   // Check argument count
   if (node.arguments.size() != func_info->parameter_types.size()) {
-    error(node.location, "Function '" + node.function_name + "' expects " +
-                             std::to_string(func_info->parameter_types.size()) +
-                             " arguments, got " +
-                             std::to_string(node.arguments.size()));
+    error(node.location,
+          "Function '" + node.function_name.str() + "' expects " +
+              std::to_string(func_info->parameter_types.size()) +
+              " arguments, got " + std::to_string(node.arguments.size()));
     return nullptr;
   }
 
@@ -482,15 +483,15 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(
   for (size_t i = 0; i < node.arguments.size(); ++i) {
     if (!node.arguments[i]) continue;
 
-    std::unique_ptr<TypeNode> arg_type = node.arguments[i]->accept(*this);
+    TypeNode* arg_type = node.arguments[i]->accept(*this);
     if (!arg_type) return nullptr;
 
     // Check if argument type matches parameter type
-    if (!arg_type->isEqualTo(func_info->parameter_types[i].get())) {
+    if (!arg_type->isEqualTo(func_info->parameter_types[i])) {
       // Allow integer literal to integer type compatibility
-      auto* arg_literal = dynamic_cast<IntegerLiteralTypeNode*>(arg_type.get());
+      auto* arg_literal = dyn_cast<IntegerLiteralTypeNode>(arg_type);
       auto* param_int =
-          dynamic_cast<IntegerTypeNode*>(func_info->parameter_types[i].get());
+          dyn_cast<IntegerTypeNode>(func_info->parameter_types[i]);
 
       if (!(arg_literal && param_int)) {
         error(node.location, "Argument " + std::to_string(i + 1) +
@@ -510,9 +511,9 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(
   }
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(BuiltinCallExpr& node) {
-  std::cout << "[SemanticAnalyzer] Analyzing builtin call: $$"
-            << node.builtin_name << std::endl;
+TypeNode* SemanticAnalyzer::visit(BuiltinCallExpr& node) {
+  LOOM_DEBUG("[SemanticAnalyzer] Analyzing builtin call: $$",
+             node.builtin_name);
 
   // Validate arguments
   for (auto& arg : node.arguments) {
@@ -530,8 +531,8 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(BuiltinCallExpr& node) {
       return nullptr;
     }
     // Return void for print
-    return std::make_unique<IntegerTypeNode>(node.location, 32,
-                                             true);  // i32 for now
+    return arena.create<IntegerTypeNode>(node.location, 32,
+                                         true);  // i32 for now
   } else if (node.builtin_name == "exit") {
     // $$exit takes an integer exit code
     if (node.arguments.size() != 1) {
@@ -539,8 +540,8 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(BuiltinCallExpr& node) {
                                std::to_string(node.arguments.size()));
       return nullptr;
     }  // Return void (never returns)
-    return std::make_unique<IntegerTypeNode>(node.location, 32,
-                                             true);  // i32 for now
+    return arena.create<IntegerTypeNode>(node.location, 32,
+                                         true);  // i32 for now
   } else if (node.builtin_name == "syscall") {
     // $$syscall takes syscall number + up to 6 arguments (Windows API mapping)
     if (node.arguments.size() < 1 || node.arguments.size() > 7) {
@@ -551,54 +552,73 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(BuiltinCallExpr& node) {
       return nullptr;
     }
     // Return i64 (syscall return value)
-    return std::make_unique<IntegerTypeNode>(node.location, 64, true);  // i64
+    return arena.create<IntegerTypeNode>(node.location, 64, true);  // i64
   } else {
-    error(node.location, "Unknown builtin function: $$" + node.builtin_name);
+    error(node.location,
+          "Unknown builtin function: $$" + std::string(node.builtin_name));
     return nullptr;
   }
 }
 
 // Function-related visitor implementations
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(FunctionDeclNode& node) {
+bool SemanticAnalyzer::declareFunction(FunctionDeclNode& node) {
   if (symbols.isFunction(node.name)) {
-    error(node.location, "Function '" + node.name + "' already defined.");
-    return nullptr;
+    error(node.location, "Function '" + node.name.str() + "' already defined.");
+    return false;
   }
 
-  std::vector<std::shared_ptr<TypeNode>> param_types;
-  std::vector<std::string> param_names;
+  std::vector<TypeNode*> param_types;
+  std::vector<Symbol> param_names;
 
   for (auto& param : node.parameters) {
     auto param_type = param->type->accept(*this);
-    if (!param_type) return nullptr;
+    if (!param_type) return false;
 
     if (std::find(param_names.begin(), param_names.end(), param->name) !=
         param_names.end()) {
-      error(param->location, "Duplicate parameter name: " + param->name);
-      return nullptr;
+      error(param->location, "Duplicate parameter name: " + param->name.str());
+      return false;
     }
-    param_types.push_back(std::shared_ptr<TypeNode>(std::move(param_type)));
+    param_types.push_back(param_type);
     param_names.push_back(param->name);
   }
 
-  std::shared_ptr<TypeNode> return_type = nullptr;
+  TypeNode* return_type = nullptr;
   if (node.return_type) {
     auto ret_type = node.return_type->accept(*this);
-    if (!ret_type) return nullptr;
-    return_type = std::shared_ptr<TypeNode>(ret_type.release());
+    if (!ret_type) return false;
+    return_type = ret_type;
   }
 
   if (!symbols.defineFunction(node.name, param_types, param_names,
                               return_type)) {
     error(node.location, "Failed to define function");
+    return false;
+  }
+  return true;
+}
+
+TypeNode* SemanticAnalyzer::visit(FunctionDeclNode& node) {
+  llvm::TimeTraceScope time_scope("Sema function", node.name.str());
+
+  // Top-level functions were already declared by analyze()
+  auto declared = declared_functions.find(&node);
+  if (declared == declared_functions.end()) {
+    if (!declareFunction(node)) return nullptr;
+  } else if (!declared->second) {
     return nullptr;
   }
+  // Never reached from main, so its body was never parsed
+  if (node.body_pending) return nullptr;
 
+  // Copy the signature; entering the function scope may move the table
+  FunctionInfo info = *symbols.lookupFunction(node.name);
   symbols.enterFunction(node.name);
 
   // Parameter in lokalen Scope hinzufügen
-  for (size_t i = 0; i < node.parameters.size(); ++i) {
-    symbols.defineVariable(param_names[i], VarDeclKind::LET, param_types[i]);
+  for (size_t i = 0; i < info.parameter_names.size(); ++i) {
+    symbols.defineVariable(info.parameter_names[i], VarDeclKind::LET,
+                           info.parameter_types[i]);
   }
 
   // Body analysieren
@@ -612,7 +632,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(FunctionDeclNode& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(ParameterNode& node) {
+TypeNode* SemanticAnalyzer::visit(ParameterNode& node) {
   // TODO: Implement parameter analysis
   // For now, just return the parameter's type
   if (node.type) {
@@ -622,7 +642,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(ParameterNode& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(ReturnStmtNode& node) {
+TypeNode* SemanticAnalyzer::visit(ReturnStmtNode& node) {
   // TODO: Implement return statement analysis
   // For now, just analyze the expression if present
   if (node.expression) {
@@ -634,7 +654,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(ReturnStmtNode& node) {
 
 // Memory model visitor implementations
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(ReferenceTypeNode& node) {
+TypeNode* SemanticAnalyzer::visit(ReferenceTypeNode& node) {
   // Analyze the referenced type
   if (node.referenced_type) {
     node.referenced_type->accept(*this);
@@ -643,7 +663,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(ReferenceTypeNode& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(OwnedPointerTypeNode& node) {
+TypeNode* SemanticAnalyzer::visit(OwnedPointerTypeNode& node) {
   // Analyze the pointed type
   if (node.pointed_type) {
     node.pointed_type->accept(*this);
@@ -652,7 +672,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(OwnedPointerTypeNode& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(NullableTypeNode& node) {
+TypeNode* SemanticAnalyzer::visit(NullableTypeNode& node) {
   // Analyze the inner type first
   if (!node.inner_type) {
     error(node.location, "Nullable type node missing inner type");
@@ -666,17 +686,16 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(NullableTypeNode& node) {
   }
 
   // Return a copy of the nullable type with the validated inner type
-  auto cloned_inner = cloneType(inner_type.get());
+  auto cloned_inner = cloneType(inner_type);
   if (!cloned_inner) {
     error(node.location, "Cannot clone inner type for nullable");
     return nullptr;
   }
 
-  return std::make_unique<NullableTypeNode>(node.location,
-                                            std::move(cloned_inner));
+  return arena.create<NullableTypeNode>(node.location, cloned_inner);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(SliceTypeNode& node) {
+TypeNode* SemanticAnalyzer::visit(SliceTypeNode& node) {
   // Analyze the element type
   if (node.element_type) {
     node.element_type->accept(*this);
@@ -685,7 +704,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(SliceTypeNode& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(ReferenceExpr& node) {
+TypeNode* SemanticAnalyzer::visit(ReferenceExpr& node) {
   // Taking a reference of an expression
   if (!node.operand) {
     error(node.location, "Reference expression missing operand");
@@ -699,11 +718,10 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(ReferenceExpr& node) {
   }
 
   // Create a reference type from the operand type
-  return std::make_unique<ReferenceTypeNode>(node.location,
-                                             std::move(operand_type));
+  return arena.create<ReferenceTypeNode>(node.location, operand_type);
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(DereferenceExpr& node) {
+TypeNode* SemanticAnalyzer::visit(DereferenceExpr& node) {
   // Dereferencing a pointer or reference
   if (!node.operand) {
     error(node.location, "Dereference expression missing operand");
@@ -716,56 +734,50 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(DereferenceExpr& node) {
     return nullptr;
   }
   // Check if operand is a reference or owned pointer
-  if (auto ref_type = dynamic_cast<ReferenceTypeNode*>(operand_type.get())) {
-    // Return a copy of the referenced type - we need to clone it properly
-    auto referenced = ref_type->referenced_type.get();
-    if (auto int_type = dynamic_cast<IntegerTypeNode*>(referenced)) {
-      return std::make_unique<IntegerTypeNode>(
-          int_type->location, int_type->bit_width, int_type->is_signed);
-    } else if (auto float_type = dynamic_cast<FloatTypeNode*>(referenced)) {
-      return std::make_unique<FloatTypeNode>(float_type->location,
-                                             float_type->bit_width);
-    } else if (auto bool_type = dynamic_cast<BooleanTypeNode*>(referenced)) {
-      return std::make_unique<BooleanTypeNode>(bool_type->location);
-    } else if (auto string_type = dynamic_cast<StringTypeNode*>(referenced)) {
-      return std::make_unique<StringTypeNode>(string_type->location);
+  TypeNode* pointee = nullptr;
+  switch (operand_type->getKind()) {
+    case NodeKind::ReferenceTypeNode:
+      pointee = cast<ReferenceTypeNode>(operand_type)->referenced_type;
+      break;
+    case NodeKind::OwnedPointerTypeNode:
+      pointee = cast<OwnedPointerTypeNode>(operand_type)->pointed_type;
+      break;
+    case NodeKind::NullableTypeNode:
+      // Cannot directly dereference nullable - need null check first
+      error(node.location,
+            "Cannot dereference nullable type '" +
+                operand_type->getTypeName() +
+                "' without null check. Use pattern matching or explicit "
+                "checks.");
+      return nullptr;
+    default:
+      error(node.location, "Cannot dereference non-pointer type '" +
+                               operand_type->getTypeName() +
+                               "'. Only references (&T) and owned pointers "
+                               "(^T) can be dereferenced.");
+      return nullptr;
+  }
+
+  // Return a copy of the pointed-to type
+  if (pointee) {
+    switch (pointee->getKind()) {
+      case NodeKind::IntegerTypeNode:
+      case NodeKind::FloatTypeNode:
+      case NodeKind::BooleanTypeNode:
+      case NodeKind::StringTypeNode:
+        return cloneType(pointee);
+      default:
+        break;  // Add more type cloning as needed
     }
-    // Add more type cloning as needed
-    error(node.location, "Cannot dereference reference to unknown type");
-    return nullptr;
-  } else if (auto owned_type =
-                 dynamic_cast<OwnedPointerTypeNode*>(operand_type.get())) {
-    // Return a copy of the pointed type - we need to clone it properly
-    auto pointed = owned_type->pointed_type.get();
-    if (auto int_type = dynamic_cast<IntegerTypeNode*>(pointed)) {
-      return std::make_unique<IntegerTypeNode>(
-          int_type->location, int_type->bit_width, int_type->is_signed);
-    } else if (auto float_type = dynamic_cast<FloatTypeNode*>(pointed)) {
-      return std::make_unique<FloatTypeNode>(float_type->location,
-                                             float_type->bit_width);
-    } else if (auto bool_type = dynamic_cast<BooleanTypeNode*>(pointed)) {
-      return std::make_unique<BooleanTypeNode>(bool_type->location);
-    } else if (auto string_type = dynamic_cast<StringTypeNode*>(pointed)) {
-      return std::make_unique<StringTypeNode>(string_type->location);
-    }  // Add more type cloning as needed
-    error(node.location, "Cannot dereference owned pointer to unknown type");
-    return nullptr;
-  } else if (dynamic_cast<NullableTypeNode*>(operand_type.get())) {
-    // Cannot directly dereference nullable - need null check first
-    error(node.location,
-          "Cannot dereference nullable type '" + operand_type->getTypeName() +
-              "' without null check. Use pattern matching or explicit checks.");
-    return nullptr;
-  } else {
-    error(node.location, "Cannot dereference non-pointer type '" +
-                             operand_type->getTypeName() +
-                             "'. Only references (&T) and owned pointers (^T) "
-                             "can be dereferenced.");
-    return nullptr;
   }
+  error(node.location,
+        isa<ReferenceTypeNode>(operand_type)
+            ? "Cannot dereference reference to unknown type"
+            : "Cannot dereference owned pointer to unknown type");
+  return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(MemberAccessExpr& node) {
+TypeNode* SemanticAnalyzer::visit(MemberAccessExpr& node) {
   // Member access: obj.field
   if (!node.object) {
     error(node.location, "Member access expression missing object");
@@ -784,7 +796,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(MemberAccessExpr& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(PointerAccessExpr& node) {
+TypeNode* SemanticAnalyzer::visit(PointerAccessExpr& node) {
   // Pointer access: ptr->field
   if (!node.pointer) {
     error(node.location, "Pointer access expression missing pointer");
@@ -803,7 +815,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(PointerAccessExpr& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(SliceExpr& node) {
+TypeNode* SemanticAnalyzer::visit(SliceExpr& node) {
   // Slice expression: arr[start..end]
   if (!node.array) {
     error(node.location, "Slice expression missing array");
@@ -818,12 +830,12 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(SliceExpr& node) {
 
   // Analyze start and end indices if present
   if (node.start) {
-    auto start_type = node.start->accept(*this);
+    node.start->accept(*this);
     // TODO: Check that start is an integer type
   }
 
   if (node.end) {
-    auto end_type = node.end->accept(*this);
+    node.end->accept(*this);
     // TODO: Check that end is an integer type
   }
 
@@ -832,7 +844,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(SliceExpr& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(DeferStmtNode& node) {
+TypeNode* SemanticAnalyzer::visit(DeferStmtNode& node) {
   // Defer statement: defer statement
   if (!node.deferred_statement) {
     error(node.location, "Defer statement missing deferred statement");
@@ -846,7 +858,7 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(DeferStmtNode& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visit(UnsafeBlockExpr& node) {
+TypeNode* SemanticAnalyzer::visit(UnsafeBlockExpr& node) {
   // Unsafe block: unsafe { ... }
   // Analyze all statements in the unsafe block
   for (auto& stmt : node.statements) {
@@ -860,38 +872,46 @@ std::unique_ptr<TypeNode> SemanticAnalyzer::visit(UnsafeBlockExpr& node) {
   return nullptr;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::cloneType(TypeNode* type) {
+TypeNode* SemanticAnalyzer::cloneType(TypeNode* type) {
   if (!type) return nullptr;
 
-  if (auto int_type = dynamic_cast<IntegerTypeNode*>(type)) {
-    return std::make_unique<IntegerTypeNode>(
-        int_type->location, int_type->bit_width, int_type->is_signed);
-  } else if (auto float_type = dynamic_cast<FloatTypeNode*>(type)) {
-    return std::make_unique<FloatTypeNode>(float_type->location,
-                                           float_type->bit_width);
-  } else if (auto bool_type = dynamic_cast<BooleanTypeNode*>(type)) {
-    return std::make_unique<BooleanTypeNode>(bool_type->location);
-  } else if (auto string_type = dynamic_cast<StringTypeNode*>(type)) {
-    return std::make_unique<StringTypeNode>(string_type->location);
-  } else if (auto null_type = dynamic_cast<NullTypeNode*>(type)) {
-    return std::make_unique<NullTypeNode>(null_type->location);
-  } else if (auto nullable_type = dynamic_cast<NullableTypeNode*>(type)) {
-    auto cloned_inner = cloneType(nullable_type->inner_type.get());
-    if (!cloned_inner) return nullptr;
-    return std::make_unique<NullableTypeNode>(nullable_type->location,
-                                              std::move(cloned_inner));
-  } else if (auto ref_type = dynamic_cast<ReferenceTypeNode*>(type)) {
-    auto cloned_ref = cloneType(ref_type->referenced_type.get());
-    if (!cloned_ref) return nullptr;
-    return std::make_unique<ReferenceTypeNode>(ref_type->location,
-                                               std::move(cloned_ref));
-  } else if (auto owned_type = dynamic_cast<OwnedPointerTypeNode*>(type)) {
-    auto cloned_pointed = cloneType(owned_type->pointed_type.get());
-    if (!cloned_pointed) return nullptr;
-    return std::make_unique<OwnedPointerTypeNode>(owned_type->location,
-                                                  std::move(cloned_pointed));
-  }
-
-  // Add more type cloning as needed for other type nodes
-  return nullptr;
+  switch (type->getKind()) {
+    case NodeKind::IntegerTypeNode: {
+      auto int_type = cast<IntegerTypeNode>(type);
+      return arena.create<IntegerTypeNode>(
+          int_type->location, int_type->bit_width, int_type->is_signed);
+    }
+    case NodeKind::FloatTypeNode: {
+      auto float_type = cast<FloatTypeNode>(type);
+      return arena.create<FloatTypeNode>(float_type->location,
+                                         float_type->bit_width);
+    }
+    case NodeKind::BooleanTypeNode:
+      return arena.create<BooleanTypeNode>(type->location);
+    case NodeKind::StringTypeNode:
+      return arena.create<StringTypeNode>(type->location);
+    case NodeKind::NullTypeNode:
+      return arena.create<NullTypeNode>(type->location);
+    case NodeKind::NullableTypeNode: {
+      auto cloned_inner = cloneType(cast<NullableTypeNode>(type)->inner_type);
+      if (!cloned_inner) return nullptr;
+      return arena.create<NullableTypeNode>(type->location, cloned_inner);
+    }
+    case NodeKind::ReferenceTypeNode: {
+      auto cloned_ref =
+          cloneType(cast<ReferenceTypeNode>(type)->referenced_type);
+      if (!cloned_ref) return nullptr;
+      return arena.create<ReferenceTypeNode>(type->location, cloned_ref);
+    }
+    case NodeKind::OwnedPointerTypeNode: {
+      auto cloned_pointed =
+          cloneType(cast<OwnedPointerTypeNode>(type)->pointed_type);
+      if (!cloned_pointed) return nullptr;
+      return arena.create<OwnedPointerTypeNode>(type->location,
+                                                cloned_pointed);
+    }
+    default:
+      // Add more type cloning as needed for other type nodes
+      return nullptr;
+  }
 }
\ No newline at end of file
@@ -1,57 +1,71 @@
 // semantic_analyzer.hh
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
+#include "common/arena.hh"
+#include "scanner/source_manager.hh"
 #include "parser/ast.hh"
 #include "symbol_table.hh"
 
 class SemanticAnalyzer : public ASTVisitor {
  private:
+  // Every type sema builds lives here, including the inferred types it
+  // stores into the AST, so the arena has to outlive code generation
+  Arena& arena;
+  const SourceManager& sources;  // resolves locations in diagnostics
   SymbolTable symbols;
   bool had_error = false;
+  // Top-level functions declared up front by analyze(), mapped to whether
+  // their signature was valid. Lets functions be called before (or in a
+  // different file than) their definition.
+  std::unordered_map<const FunctionDeclNode*, bool> declared_functions;
+  bool declareFunction(FunctionDeclNode& node);
   void error(const LoomSourceLocation& loc, const std::string& message);
-  std::unique_ptr<TypeNode> cloneType(TypeNode* type);
+  TypeNode* cloneType(TypeNode* type);
 
  public:
-  SemanticAnalyzer();
-  void analyze(const std::vector<std::unique_ptr<StmtNode>>& ast);
+  SemanticAnalyzer(Arena& arena, const SourceManager& sources);
+  void analyze(const std::vector<StmtNode*>& ast);
   bool hasError() const { return had_error; }
 
-  std::unique_ptr<TypeNode> visit(NumberLiteral& node) override;
-  std::unique_ptr<TypeNode> visit(StringLiteral& node) override;
-  std::unique_ptr<TypeNode> visit(BooleanLiteral& node) override;
-  std::unique_ptr<TypeNode> visit(Identifier& node) override;
-  std::unique_ptr<TypeNode> visit(BinaryExpr& node) override;
-  std::unique_ptr<TypeNode> visit(UnaryExpr& node) override;
-  std::unique_ptr<TypeNode> visit(AssignmentExpr& node) override;
-  std::unique_ptr<TypeNode> visit(VarDeclNode& node) override;
-  std::unique_ptr<TypeNode> visit(ExprStmtNode& node) override;
-  std::unique_ptr<TypeNode> visit(IfStmtNode& node) override;
-  std::unique_ptr<TypeNode> visit(WhileStmtNode& node) override;
-  std::unique_ptr<TypeNode> visit(FunctionCallExpr& node) override;
-  std::unique_ptr<TypeNode> visit(TypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(IntegerTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(FloatTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(BooleanTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(StringTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(NullTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(IntegerLiteralTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(
+  TypeNode* visit(NumberLiteral& node) override;
+  TypeNode* visit(StringLiteral& node) override;
+  TypeNode* visit(BooleanLiteral& node) override;
+  TypeNode* visit(Identifier& node) override;
+  TypeNode* visit(BinaryExpr& node) override;
+  TypeNode* visit(UnaryExpr& node) override;
+  TypeNode* visit(AssignmentExpr& node) override;
+  TypeNode* visit(VarDeclNode& node) override;
+  TypeNode* visit(ExprStmtNode& node) override;
+  TypeNode* visit(IfStmtNode& node) override;
+  TypeNode* visit(WhileStmtNode& node) override;
+  TypeNode* visit(FunctionCallExpr& node) override;
+  TypeNode* visit(TypeNode& node) override;
+  TypeNode* visit(IntegerTypeNode& node) override;
+  TypeNode* visit(FloatTypeNode& node) override;
+  TypeNode* visit(BooleanTypeNode& node) override;
+  TypeNode* visit(StringTypeNode& node) override;
+  TypeNode* visit(NullTypeNode& node) override;
+  TypeNode* visit(IntegerLiteralTypeNode& node) override;
+  TypeNode* visit(
       FloatLiteralTypeNode& node) override;  // Function-related visitors
-  std::unique_ptr<TypeNode> visit(FunctionDeclNode& node) override;
-  std::unique_ptr<TypeNode> visit(ParameterNode& node) override;
-  std::unique_ptr<TypeNode> visit(ReturnStmtNode& node) override;
-  std::unique_ptr<TypeNode> visit(BuiltinCallExpr& node) override;
+  TypeNode* visit(FunctionDeclNode& node) override;
+  TypeNode* visit(ParameterNode& node) override;
+  TypeNode* visit(ReturnStmtNode& node) override;
+  TypeNode* visit(BuiltinCallExpr& node) override;
 
   // Memory model visitors
-  std::unique_ptr<TypeNode> visit(ReferenceTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(OwnedPointerTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(NullableTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(SliceTypeNode& node) override;
-  std::unique_ptr<TypeNode> visit(ReferenceExpr& node) override;
-  std::unique_ptr<TypeNode> visit(DereferenceExpr& node) override;
-  std::unique_ptr<TypeNode> visit(MemberAccessExpr& node) override;
-  std::unique_ptr<TypeNode> visit(PointerAccessExpr& node) override;
-  std::unique_ptr<TypeNode> visit(SliceExpr& node) override;
-  std::unique_ptr<TypeNode> visit(DeferStmtNode& node) override;
-  std::unique_ptr<TypeNode> visit(UnsafeBlockExpr& node) override;
+  TypeNode* visit(ReferenceTypeNode& node) override;
+  TypeNode* visit(OwnedPointerTypeNode& node) override;
+  TypeNode* visit(NullableTypeNode& node) override;
+  TypeNode* visit(SliceTypeNode& node) override;
+  TypeNode* visit(ReferenceExpr& node) override;
+  TypeNode* visit(DereferenceExpr& node) override;
+  TypeNode* visit(MemberAccessExpr& node) override;
+  TypeNode* visit(PointerAccessExpr& node) override;
+  TypeNode* visit(SliceExpr& node) override;
+  TypeNode* visit(DeferStmtNode& node) override;
+  TypeNode* visit(UnsafeBlockExpr& node) override;
 };
\ No newline at end of file
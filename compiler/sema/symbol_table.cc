@@ -8,7 +8,7 @@ void SymbolTable::leaveScope() {
 }
 
 // KORREKTUR: Nimmt info per Wert und movt sie in die Map
-bool SymbolTable::define(const std::string& name, SymbolInfo info) {
+bool SymbolTable::define(Symbol name, SymbolInfo info) {
   if (scopes.back().count(name) > 0) {
     return false;
   }
@@ -16,7 +16,7 @@ bool SymbolTable::define(const std::string& name, SymbolInfo info) {
   return true;
 }
 
-const SymbolInfo* SymbolTable::lookup(const std::string& name) const {
+const SymbolInfo* SymbolTable::lookup(Symbol name) const {
   for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
     const auto& scope = *it;
     auto symbol_it = scope.find(name);
@@ -27,8 +27,8 @@ const SymbolInfo* SymbolTable::lookup(const std::string& name) const {
   return nullptr;
 }
 
-bool SymbolTable::defineVariable(const std::string& name, VarDeclKind var_kind,
-                                 std::shared_ptr<TypeNode> type) {
+bool SymbolTable::defineVariable(Symbol name, VarDeclKind var_kind,
+                                 TypeNode* type) {
   VariableInfo var_info{var_kind, type};
   SymbolInfo symbol_info;
   symbol_info.kind = SymbolKind::VARIABLE;
@@ -38,9 +38,8 @@ bool SymbolTable::defineVariable(const std::string& name, VarDeclKind var_kind,
 }
 
 bool SymbolTable::defineFunction(
-    const std::string& name, std::vector<std::shared_ptr<TypeNode>> param_types,
-    std::vector<std::string> param_names,
-    std::shared_ptr<TypeNode> return_type) {
+    Symbol name, std::vector<TypeNode*> param_types,
+    std::vector<Symbol> param_names, TypeNode* return_type) {
   FunctionInfo func_info{param_types, return_type, param_names};
   SymbolInfo info;
   info.kind = SymbolKind::FUNCTION;
@@ -49,7 +48,7 @@ bool SymbolTable::defineFunction(
   return define(name, info);
 }
 
-const VariableInfo* SymbolTable::lookupVariable(const std::string& name) const {
+const VariableInfo* SymbolTable::lookupVariable(Symbol name) const {
   const SymbolInfo* symbol = lookup(name);
   if (symbol && symbol->kind == SymbolKind::VARIABLE) {
     return &std::get<VariableInfo>(symbol->data);
@@ -57,7 +56,7 @@ const VariableInfo* SymbolTable::lookupVariable(const std::string& name) const {
   return nullptr;
 }
 
-const FunctionInfo* SymbolTable::lookupFunction(const std::string& name) const {
+const FunctionInfo* SymbolTable::lookupFunction(Symbol name) const {
   const SymbolInfo* symbol = lookup(name);
 
   if (symbol && symbol->kind == SymbolKind::FUNCTION) {
@@ -67,28 +66,30 @@ const FunctionInfo* SymbolTable::lookupFunction(const std::string& name) const {
   return nullptr;
 }
 
-const std::string& SymbolTable::getCurrentFunction() const {
+Symbol SymbolTable::getCurrentFunction() const {
   return current_function_name;
 }
 
-bool SymbolTable::isInFunction() const { return current_function_name != ""; }
+bool SymbolTable::isInFunction() const {
+  return !current_function_name.empty();
+}
 
-void SymbolTable::enterFunction(const std::string& function_name) {
+void SymbolTable::enterFunction(Symbol function_name) {
   current_function_name = function_name;
   enterScope();
 }
 
 void SymbolTable::leaveFunction() {
-  current_function_name = "";
+  current_function_name = Symbol();
   leaveScope();
 }
 
-bool SymbolTable::isVariable(const std::string& name) const {
+bool SymbolTable::isVariable(Symbol name) const {
   const SymbolInfo* symbol = lookup(name);
   return symbol && symbol->kind == SymbolKind::VARIABLE;
 }
 
-bool SymbolTable::isFunction(const std::string& name) const {
+bool SymbolTable::isFunction(Symbol name) const {
   const SymbolInfo* symbol = lookup(name);
   return symbol && symbol->kind == SymbolKind::FUNCTION;
 }
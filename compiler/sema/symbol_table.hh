@@ -1,7 +1,6 @@
 // symbol_table.hh
 #pragma once
 
-#include <memory>
 #include <string>
 #include <unordered_map>
 #include <variant>
@@ -13,13 +12,13 @@ enum class SymbolKind { VARIABLE, FUNCTION, TYPE };
 
 struct VariableInfo {
   VarDeclKind kind;
-  std::shared_ptr<TypeNode> type;
+  TypeNode* type;
 };
 
 struct FunctionInfo {
-  std::vector<std::shared_ptr<TypeNode>> parameter_types;
-  std::shared_ptr<TypeNode> return_type;
-  std::vector<std::string> parameter_names;
+  std::vector<TypeNode*> parameter_types;
+  TypeNode* return_type;
+  std::vector<Symbol> parameter_names;
 };
 
 // 3. Dann SymbolInfo (verwendet die obigen)
@@ -30,32 +29,29 @@ struct SymbolInfo {
 
 class SymbolTable {
  private:
-  std::vector<std::unordered_map<std::string, SymbolInfo>> scopes;
-  std::string current_function_name;  // Für Return-Statement validation
+  std::vector<std::unordered_map<Symbol, SymbolInfo>> scopes;
+  Symbol current_function_name;  // Für Return-Statement validation
  public:
   SymbolTable();
   void enterScope();
   void leaveScope();
-  bool define(const std::string& name, SymbolInfo info);
+  bool define(Symbol name, SymbolInfo info);
 
-  const SymbolInfo* lookup(const std::string& name) const;
+  const SymbolInfo* lookup(Symbol name) const;
 
   // Convenience methods
-  bool defineVariable(const std::string& name, VarDeclKind var_kind,
-                      std::shared_ptr<TypeNode> type);
-  bool defineFunction(const std::string& name,
-                      std::vector<std::shared_ptr<TypeNode>> param_types,
-                      std::vector<std::string> param_names,
-                      std::shared_ptr<TypeNode> return_type);
+  bool defineVariable(Symbol name, VarDeclKind var_kind, TypeNode* type);
+  bool defineFunction(Symbol name, std::vector<TypeNode*> param_types,
+                      std::vector<Symbol> param_names, TypeNode* return_type);
 
   // Type checking helpers
-  bool isFunction(const std::string& name) const;
-  bool isVariable(const std::string& name) const;
-  const VariableInfo* lookupVariable(const std::string& name) const;
-  const FunctionInfo* lookupFunction(const std::string& name) const;
+  bool isFunction(Symbol name) const;
+  bool isVariable(Symbol name) const;
+  const VariableInfo* lookupVariable(Symbol name) const;
+  const FunctionInfo* lookupFunction(Symbol name) const;
 
-  void enterFunction(const std::string& function_name);
+  void enterFunction(Symbol function_name);
   void leaveFunction();
-  const std::string& getCurrentFunction() const;
+  Symbol getCurrentFunction() const;
   bool isInFunction() const;
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+// testing/compiler/arena_test.cc
+//
+// Arena allocations are aligned, never overlap and stay valid until the
+// arena itself is dropped, however many slabs it grows.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "common/arena.hh"
+
+static bool isAligned(const void* p, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+}
+
+struct Pair {
+  uint64_t key;
+  uint32_t value;
+
+  Pair(uint64_t k, uint32_t v) : key(k), value(v) {}
+};
+
+TEST(ArenaTest, AllocationsAreAligned) {
+  Arena arena;
+  for (size_t alignment : {1u, 2u, 4u, 8u, 16u, 64u, 4096u}) {
+    SCOPED_TRACE("alignment " + std::to_string(alignment));
+    // An odd size first, so the cursor is never already aligned
+    arena.allocate(3, 1);
+    EXPECT_TRUE(isAligned(arena.allocate(24, alignment), alignment));
+  }
+}
+
+TEST(ArenaTest, CreateConstructsInPlace) {
+  Arena arena;
+  Pair* pair = arena.create<Pair>(uint64_t{1} << 40, 7u);
+  EXPECT_TRUE(isAligned(pair, alignof(Pair)));
+  EXPECT_EQ(pair->key, uint64_t{1} << 40);
+  EXPECT_EQ(pair->value, 7u);
+}
+
+TEST(ArenaTest, CopyMovesVectorIntoArena) {
+  Arena arena;
+  std::vector<int> items = {1, 2, 3, 4};
+  std::span<int> copied = arena.copy(items);
+  ASSERT_EQ(copied.size(), items.size());
+  EXPECT_NE(copied.data(), items.data());
+  items.assign(items.size(), 0);
+  EXPECT_EQ(copied[0], 1);
+  EXPECT_EQ(copied[3], 4);
+
+  // An empty list takes no memory at all
+  size_t before = arena.getBytesAllocated();
+  EXPECT_TRUE(arena.copy(std::vector<int>{}).empty());
+  EXPECT_EQ(arena.getBytesAllocated(), before);
+}
+
+TEST(ArenaTest, EarlierObjectsSurviveNewSlabs) {
+  // Far more than the largest slab, so the arena grows many times
+  Arena arena;
+  std::vector<Pair*> pairs;
+  for (uint32_t i = 0; i < 200000; ++i) {
+    pairs.push_back(arena.create<Pair>(uint64_t{i} * 3, i));
+  }
+  for (uint32_t i = 0; i < pairs.size(); ++i) {
+    ASSERT_EQ(pairs[i]->key, uint64_t{i} * 3);
+    ASSERT_EQ(pairs[i]->value, i);
+  }
+  EXPECT_EQ(arena.getBytesAllocated(), pairs.size() * sizeof(Pair));
+}
+
+TEST(ArenaTest, OversizedAllocationsKeepTheCurrentSlab) {
+  Arena arena;
+  char* small = static_cast<char*>(arena.allocate(16, 1));
+  std::memset(small, 'a', 16);
+
+  // Bigger than any slab: gets memory of its own
+  const size_t big_size = (size_t{1} << 20) * 3;
+  char* big = static_cast<char*>(arena.allocate(big_size, 16));
+  EXPECT_TRUE(isAligned(big, 16));
+  std::memset(big, 'b', big_size);
+
+  // The next small allocation still comes right after the first one
+  char* next = static_cast<char*>(arena.allocate(16, 1));
+  EXPECT_EQ(next, small + 16);
+  EXPECT_EQ(small[15], 'a');
+  EXPECT_EQ(big[big_size - 1], 'b');
+  EXPECT_EQ(arena.getBytesAllocated(), 32 + big_size);
+}
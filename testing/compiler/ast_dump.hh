@@ -0,0 +1,88 @@
+// testing/compiler/ast_dump.hh
+//
+// Spells out statements with everything the parser put into them, one line
+// per statement, so two parses can be compared with a single EXPECT_EQ.
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "parser/ast.hh"
+
+inline void dumpStatement(const StmtNode* stmt, int depth, std::string& out);
+
+inline void dumpStatements(NodeList<StmtNode> statements, int depth,
+                           std::string& out) {
+  for (const StmtNode* stmt : statements) {
+    dumpStatement(stmt, depth, out);
+  }
+}
+
+inline void dumpStatement(const StmtNode* stmt, int depth, std::string& out) {
+  out.append(static_cast<size_t>(depth) * 2, ' ');
+  if (!stmt) {
+    out += "null\n";
+    return;
+  }
+  out += "@" + std::to_string(stmt->location.offset) + " ";
+  switch (stmt->getKind()) {
+    case NodeKind::VarDeclNode: {
+      auto* decl = cast<VarDeclNode>(stmt);
+      static const char* const kinds[] = {"let", "mut", "define"};
+      out += std::string(kinds[static_cast<int>(decl->kind)]) + " " +
+             decl->name.str() + ": " +
+             (decl->type ? decl->type->toString() : "?") + " = " +
+             (decl->initializer ? decl->initializer->toString() : "none") +
+             "\n";
+      break;
+    }
+    case NodeKind::FunctionDeclNode: {
+      auto* func = cast<FunctionDeclNode>(stmt);
+      out += "func " + func->name.str() + "(";
+      for (const ParameterNode* param : func->parameters) {
+        out += param->toString() + ", ";
+      }
+      out += ") " + (func->return_type ? func->return_type->toString()
+                                        : std::string("void"));
+      if (func->body_pending) {
+        out += " pending @" + std::to_string(func->body_begin.offset) + "+" +
+               std::to_string(func->body_length);
+      }
+      out += "\n";
+      dumpStatements(func->body, depth + 1, out);
+      break;
+    }
+    case NodeKind::IfStmtNode: {
+      auto* if_stmt = cast<IfStmtNode>(stmt);
+      out += "if " + if_stmt->condition->toString() + "\n";
+      dumpStatements(if_stmt->then_body, depth + 1, out);
+      out.append(static_cast<size_t>(depth) * 2, ' ');
+      out += "else\n";
+      dumpStatements(if_stmt->else_body, depth + 1, out);
+      break;
+    }
+    case NodeKind::WhileStmtNode: {
+      auto* while_stmt = cast<WhileStmtNode>(stmt);
+      out += "while " + while_stmt->condition->toString() + "\n";
+      dumpStatements(while_stmt->body, depth + 1, out);
+      break;
+    }
+    case NodeKind::DeferStmtNode:
+      out += "defer\n";
+      dumpStatement(cast<DeferStmtNode>(stmt)->deferred_statement, depth + 1,
+                    out);
+      break;
+    default:
+      // Expressions spell out all of their operands
+      out += stmt->toString() + "\n";
+      break;
+  }
+}
+
+inline std::string dumpAST(const std::vector<StmtNode*>& statements) {
+  std::string out;
+  for (const StmtNode* stmt : statements) {
+    dumpStatement(stmt, 0, out);
+  }
+  return out;
+}
@@ -0,0 +1,146 @@
+// testing/compiler/parser_lazy_body_test.cc
+//
+// With lazy function bodies only the bodies reachable from main are parsed;
+// the others stay pending, syntax errors in them included.
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast_dump.hh"
+#include "parser/parser_internal.hh"
+#include "parser/reachability.hh"
+#include "scanner/source_manager.hh"
+
+// main reaches helper directly, inner through helper's if, deep through a
+// function nested in inner, and from_global from a top-level declaration
+static const char* const kSource = R"LOOM(let g: i32 = from_global();
+func main() i32 {
+    let r: i32 = helper(5);
+    return r;
+}
+func helper(x: i32) i32 {
+    if (x > 3) {
+        return inner(x);
+    }
+    return x;
+}
+func inner(x: i32) i32 {
+    func nested() i32 {
+        return deep();
+    }
+    return x * 2;
+}
+func deep() i32 { return 1; }
+func from_global() i32 { return 2; }
+func unused(x: i32) i32 {
+    return unused_too(x);
+}
+func unused_too(x: i32) i32 { return x; }
+)LOOM";
+
+// A file parsed with Parser::parse, together with what owns its AST
+class ParsedSource {
+ public:
+  ParsedSource(std::string_view source, bool lazy) {
+    file = sources.addBuffer("test.loom", source);
+    Scanner scanner(file->getText(), file->getFilename());
+    TokenStream tokens(scanner);
+    Parser parser(tokens, *file, arena, diagnostics);
+    parser.setLazyFunctionBodies(lazy);
+    ast = parser.parse();
+    had_error = parser.hasError();
+  }
+
+  // Runs parseReachableBodies, recording the functions it parsed
+  bool parseReachable() {
+    return parseReachableBodies(ast, [&](FunctionDeclNode& func) {
+      parsed.insert(func.name.str());
+      return parseSkippedBody(func, *file, arena, diagnostics);
+    });
+  }
+
+  FunctionDeclNode* function(std::string_view name) const {
+    for (StmtNode* stmt : ast) {
+      auto* func = dyn_cast<FunctionDeclNode>(stmt);
+      if (func && func->name.str() == name) return func;
+    }
+    return nullptr;
+  }
+
+  SourceManager sources;
+  const LoomSourceFile* file = nullptr;
+  Arena arena;
+  std::ostringstream diagnostics;
+  std::vector<StmtNode*> ast;
+  bool had_error = false;
+  std::set<std::string> parsed;
+};
+
+TEST(ParserLazyBodyTest, OnlyReachableBodiesAreParsed) {
+  // A syntax error nobody can reach is never looked at
+  const std::string source =
+      std::string(kSource) + "func broken() i32 {\n    return 1 + ;\n}\n";
+  ParsedSource lazy(source, true);
+  ASSERT_FALSE(lazy.had_error);
+  for (StmtNode* stmt : lazy.ast) {
+    if (auto* func = dyn_cast<FunctionDeclNode>(stmt)) {
+      EXPECT_TRUE(func->body_pending) << func->name.str();
+      EXPECT_TRUE(func->body.empty()) << func->name.str();
+    }
+  }
+
+  EXPECT_TRUE(lazy.parseReachable());
+  EXPECT_EQ(lazy.diagnostics.str(), "");
+  // nested is parsed along with inner, since inner's body is parsed eagerly
+  EXPECT_EQ(lazy.parsed, (std::set<std::string>{"main", "helper", "inner",
+                                                 "deep", "from_global"}));
+  for (const char* name : {"main", "helper", "inner", "deep", "from_global"}) {
+    EXPECT_FALSE(lazy.function(name)->body_pending) << name;
+    EXPECT_FALSE(lazy.function(name)->body.empty()) << name;
+  }
+  for (const char* name : {"unused", "unused_too", "broken"}) {
+    EXPECT_TRUE(lazy.function(name)->body_pending) << name;
+    EXPECT_TRUE(lazy.function(name)->body.empty()) << name;
+  }
+}
+
+TEST(ParserLazyBodyTest, ReachableSyntaxErrorIsReported) {
+  const std::string source = std::string(kSource) +
+                             "func broken() i32 {\n    return 1 + ;\n}\n" +
+                             "func caller() { broken(); }\n" +
+                             "let b: i32 = caller();\n";
+  ParsedSource lazy(source, true);
+  ASSERT_FALSE(lazy.had_error);
+  EXPECT_EQ(lazy.diagnostics.str(), "");
+
+  EXPECT_FALSE(lazy.parseReachable());
+  EXPECT_TRUE(lazy.parsed.count("broken"));
+  // Reported at the ';' where an operand was expected, like an eager parse
+  ParsedSource eager(source, false);
+  EXPECT_TRUE(eager.had_error);
+  EXPECT_EQ(lazy.diagnostics.str(), eager.diagnostics.str());
+  EXPECT_EQ(lazy.diagnostics.str(),
+            "Parse error at Line: 25, Column: 16: Expected expression\n");
+}
+
+TEST(ParserLazyBodyTest, LazyBodiesMatchEagerParse) {
+  ParsedSource eager(kSource, false);
+  ASSERT_FALSE(eager.had_error);
+
+  ParsedSource lazy(kSource, true);
+  ASSERT_FALSE(lazy.had_error);
+  EXPECT_NE(dumpAST(lazy.ast), dumpAST(eager.ast));
+  for (StmtNode* stmt : lazy.ast) {
+    if (auto* func = dyn_cast<FunctionDeclNode>(stmt)) {
+      EXPECT_TRUE(parseSkippedBody(*func, *lazy.file, lazy.arena,
+                                   lazy.diagnostics));
+    }
+  }
+  EXPECT_EQ(lazy.diagnostics.str(), "");
+  EXPECT_EQ(dumpAST(lazy.ast), dumpAST(eager.ast));
+}
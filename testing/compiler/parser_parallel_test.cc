@@ -0,0 +1,141 @@
+// testing/compiler/parser_parallel_test.cc
+//
+// parseParallel must build the AST of a serial parse, and fall back to the
+// serial parse, diagnostics and all, when any range has a syntax error.
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast_dump.hh"
+#include "parser/parser_internal.hh"
+#include "scanner/source_manager.hh"
+#include "token_helpers.hh"
+
+// Every kind of top-level declaration, and bodies with nested braces
+static std::string declarations(size_t count) {
+  std::string source;
+  for (size_t i = 0; i < count; ++i) {
+    const std::string n = std::to_string(i);
+    source += "define LIMIT_" + n + " = " + n + ";\n";
+    source += "let g_" + n + ": i32 = LIMIT_" + n + " * 2 + 1;\n";
+    source += "mut m_" + n + ": i32 = g_" + n + ";\n";
+    source += "func f_" + n + "(a: i32, b: i32) i32 {\n";
+    source += "    mut s: i32 = a;\n";
+    source += "    while (s < b) {\n        s = s + g_" + n + ";\n    }\n";
+    source += "    if (s == b) {\n        return f_" + n + "(s, b);\n";
+    source += "    } else {\n        return -s;\n    }\n}\n";
+  }
+  return source;
+}
+
+// The AST and diagnostics of a serial and a parallel parse of one file
+struct BothParses {
+  std::string serial_ast;
+  std::string serial_diagnostics;
+  bool serial_error = false;
+  std::string parallel_ast;
+  std::string parallel_diagnostics;
+  bool parallel_error = false;
+};
+
+static BothParses parseBoth(std::string_view source, bool lazy,
+                            unsigned thread_count) {
+  SourceManager sources;
+  const LoomSourceFile* file = sources.addBuffer("test.loom", source);
+  BothParses result;
+
+  Scanner scanner(file->getText(), file->getFilename());
+  TokenStream stream(scanner);
+  Arena arena;
+  std::ostringstream serial_diagnostics;
+  Parser parser(stream, *file, arena, serial_diagnostics);
+  parser.setLazyFunctionBodies(lazy);
+  result.serial_ast = dumpAST(parser.parse());
+  result.serial_diagnostics = serial_diagnostics.str();
+  result.serial_error = parser.hasError();
+
+  const std::vector<LoomToken> tokens = scanAll(file->getText());
+  std::ostringstream parallel_diagnostics;
+  ParallelParseResult parallel =
+      parseParallel(tokens, *file, parallel_diagnostics, lazy, thread_count);
+  result.parallel_ast = dumpAST(parallel.statements);
+  result.parallel_diagnostics = parallel_diagnostics.str();
+  result.parallel_error = parallel.had_error;
+  return result;
+}
+
+// Large enough for parseParallel to cut it into several ranges
+static std::string largeSource() {
+  std::string source = declarations(2000);
+  const std::vector<LoomToken> tokens = scanAll(source);
+  // parseParallel's smallest range is 1 << 14 tokens
+  EXPECT_GT(findDeclarationBoundaries(tokens, size_t{1} << 14).size(), 4u);
+  return source;
+}
+
+TEST(ParserParallelTest, DeclarationBoundaries) {
+  const std::string source =
+      "let a = 1;\nfunc f() {\n    let b = 2;\n}\ndefine c = 3;\n"
+      "mut d = 4\nlet e = 5;\n";
+  const std::vector<LoomToken> tokens = scanAll(source);
+  auto token_at = [&](std::string_view text) {
+    const size_t offset = source.find(text);
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      if (tokens[i].offset == offset) return i;
+    }
+    ADD_FAILURE() << "no token at " << text;
+    return size_t{0};
+  };
+
+  // Not at the 'let' inside f, nor at 'let e' since 'mut d' lacks its ';'
+  EXPECT_EQ(findDeclarationBoundaries(tokens, 1),
+            (std::vector<size_t>{0, token_at("func"), token_at("define"),
+                                 token_at("mut")}));
+  // Cuts only once range_size tokens have passed since the last one
+  EXPECT_EQ(findDeclarationBoundaries(tokens, 10),
+            (std::vector<size_t>{0, token_at("define")}));
+  EXPECT_EQ(findDeclarationBoundaries(tokens, tokens.size()),
+            (std::vector<size_t>{0}));
+
+  // Nothing past a stray '}' is trusted
+  const std::string stray = "let a = 1;\n}\nlet b = 2;\nlet c = 3;\n";
+  EXPECT_EQ(findDeclarationBoundaries(scanAll(stray), 1),
+            (std::vector<size_t>{0}));
+}
+
+TEST(ParserParallelTest, MatchesSerialParse) {
+  const std::string source = largeSource();
+  for (bool lazy : {false, true}) {
+    for (unsigned thread_count : {1u, 4u}) {
+      SCOPED_TRACE(std::string(lazy ? "lazy" : "eager") + ", threads " +
+                   std::to_string(thread_count));
+      BothParses parses = parseBoth(source, lazy, thread_count);
+      EXPECT_FALSE(parses.serial_error);
+      EXPECT_FALSE(parses.parallel_error);
+      EXPECT_EQ(parses.parallel_diagnostics, "");
+      EXPECT_EQ(parses.parallel_ast, parses.serial_ast);
+    }
+  }
+}
+
+TEST(ParserParallelTest, SyntaxErrorFallsBackToSerialParse) {
+  // Errors in a range in the middle of the file, one of them in a skipped
+  // body, which only a lazy parse doesn't see
+  std::string source = largeSource();
+  source.replace(source.find("return -s;", source.size() / 2), 10,
+                 "return - ;");
+  source.replace(source.find("let g_", source.size() / 3), 6, "let 7_");
+  for (bool lazy : {false, true}) {
+    SCOPED_TRACE(lazy ? "lazy" : "eager");
+    BothParses parses = parseBoth(source, lazy, 4);
+    EXPECT_TRUE(parses.serial_error);
+    EXPECT_TRUE(parses.parallel_error);
+    EXPECT_NE(parses.serial_diagnostics, "");
+    EXPECT_EQ(parses.parallel_diagnostics, parses.serial_diagnostics);
+    EXPECT_EQ(parses.parallel_ast, parses.serial_ast);
+  }
+}
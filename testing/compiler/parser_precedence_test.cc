@@ -0,0 +1,94 @@
+// testing/compiler/parser_precedence_test.cc
+//
+// Binary operators bind by precedence (* / over + - over < > <= >= over
+// ==) and associate to the left; prefix operators bind tighter than all.
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser/parser_internal.hh"
+#include "scanner/source_manager.hh"
+
+// Spells expr out with every binary and unary operation parenthesized
+static std::string parenthesize(const ExprNode* expr) {
+  if (!expr) return "null";
+  if (auto* binary = dyn_cast<BinaryExpr>(expr)) {
+    return "(" + parenthesize(binary->left) + " " +
+           operatorSpelling(binary->op) + " " + parenthesize(binary->right) +
+           ")";
+  }
+  if (auto* unary = dyn_cast<UnaryExpr>(expr)) {
+    return "(" + std::string(operatorSpelling(unary->op)) +
+           parenthesize(unary->right) + ")";
+  }
+  if (auto* identifier = dyn_cast<Identifier>(expr)) {
+    return std::string(identifier->name.str());
+  }
+  if (auto* number = dyn_cast<NumberLiteral>(expr)) {
+    return number->is_float ? std::to_string(number->float_value)
+                            : std::to_string(number->int_value);
+  }
+  if (auto* boolean = dyn_cast<BooleanLiteral>(expr)) {
+    return boolean->value ? "true" : "false";
+  }
+  return expr->toString();
+}
+
+// Parses "let r = <expression>;" and spells out the initializer
+static std::string parseExpressionText(std::string_view expression) {
+  const std::string source = "let r = " + std::string(expression) + ";";
+  SCOPED_TRACE(source);
+  SourceManager source_manager;
+  const LoomSourceFile* file = source_manager.addBuffer("test.loom", source);
+  Scanner scanner(file->getText(), file->getFilename());
+  TokenStream tokens(scanner);
+  Arena arena;
+  std::ostringstream diagnostics;
+  Parser parser(tokens, *file, arena, diagnostics);
+  std::vector<StmtNode*> statements = parser.parse();
+
+  EXPECT_FALSE(parser.hasError());
+  EXPECT_EQ(diagnostics.str(), "");
+  if (statements.size() != 1) return "<" + diagnostics.str() + ">";
+  auto* decl = dyn_cast<VarDeclNode>(statements[0]);
+  if (!decl) return "<not a declaration>";
+  return parenthesize(decl->initializer);
+}
+
+TEST(ParserPrecedenceTest, EqualityTakesAComparisonOnTheRight) {
+  // Used to stop after "a == b" and fail on "< c"
+  EXPECT_EQ(parseExpressionText("a == b < c"), "(a == (b < c))");
+  EXPECT_EQ(parseExpressionText("true == 1 < 2"), "(true == (1 < 2))");
+  EXPECT_EQ(parseExpressionText("a < b == c"), "((a < b) == c)");
+  EXPECT_EQ(parseExpressionText("a == b + c"), "(a == (b + c))");
+}
+
+TEST(ParserPrecedenceTest, TighterOperatorsBindFirst) {
+  EXPECT_EQ(parseExpressionText("a + b * c"), "(a + (b * c))");
+  EXPECT_EQ(parseExpressionText("a * b + c"), "((a * b) + c)");
+  EXPECT_EQ(parseExpressionText("a * b + c < d == e"),
+            "((((a * b) + c) < d) == e)");
+  EXPECT_EQ(parseExpressionText("e == d > c - b / a"),
+            "(e == (d > (c - (b / a))))");
+  EXPECT_EQ(parseExpressionText("a <= b + 1"), "(a <= (b + 1))");
+  EXPECT_EQ(parseExpressionText("(a + b) * c"), "((a + b) * c)");
+}
+
+TEST(ParserPrecedenceTest, SameLevelAssociatesLeft) {
+  EXPECT_EQ(parseExpressionText("a - b - c"), "((a - b) - c)");
+  EXPECT_EQ(parseExpressionText("a / b * c"), "((a / b) * c)");
+  EXPECT_EQ(parseExpressionText("a - b + c - d"), "(((a - b) + c) - d)");
+  EXPECT_EQ(parseExpressionText("a < b > c"), "((a < b) > c)");
+  EXPECT_EQ(parseExpressionText("a == b == c"), "((a == b) == c)");
+}
+
+TEST(ParserPrecedenceTest, PrefixOperatorsBindTightest) {
+  EXPECT_EQ(parseExpressionText("-a * b"), "((-a) * b)");
+  EXPECT_EQ(parseExpressionText("a - -b"), "(a - (-b))");
+  EXPECT_EQ(parseExpressionText("!a == b"), "((!a) == b)");
+  EXPECT_EQ(parseExpressionText("--a + 2.5"), "((-(-a)) + 2.500000)");
+}
@@ -0,0 +1,53 @@
+// testing/compiler/scanner_number_test.cc
+//
+// Numeric literals are decoded by the scanner; '_' separators may only sit
+// between two digits.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string_view>
+
+#include "scanner/scanner_internal.hh"
+
+static LoomToken firstToken(std::string_view source) {
+  Scanner scanner(source, "test.loom");
+  return scanner.scanNextToken();
+}
+
+TEST(ScannerNumberTest, IntegerSeparators) {
+  LoomToken token = firstToken("1_000_000");
+  ASSERT_EQ(token.type, TokenType::TOKEN_NUMBER_INT);
+  EXPECT_EQ(static_cast<uint32_t>(token.length), 9u);
+  EXPECT_EQ(token.int_value, uint64_t{1000000});
+
+  EXPECT_EQ(firstToken("0x_ff").type, TokenType::TOKEN_ERROR);
+  EXPECT_EQ(firstToken("1__0").type, TokenType::TOKEN_ERROR);
+}
+
+TEST(ScannerNumberTest, FloatSeparators) {
+  LoomToken token = firstToken("1_0.2_5");
+  ASSERT_EQ(token.type, TokenType::TOKEN_NUMBER_FLOAT);
+  EXPECT_EQ(static_cast<uint32_t>(token.length), 7u);
+  EXPECT_DOUBLE_EQ(token.float_value, 10.25);
+
+  EXPECT_EQ(firstToken("1.5__5").type, TokenType::TOKEN_ERROR);
+  EXPECT_EQ(firstToken("1.5_").type, TokenType::TOKEN_ERROR);
+}
+
+TEST(ScannerNumberTest, SeparatorRightAfterPointIsRejected) {
+  Scanner scanner("1._5", "test.loom");
+  LoomToken token = scanner.scanNextToken();
+  EXPECT_EQ(token.type, TokenType::TOKEN_ERROR);
+  EXPECT_EQ(scanner.getLastError(),
+            "Digit separator must be between digits: '_'");
+  // The token alone is enough to report it later on
+  EXPECT_EQ(scanErrorMessage(token), scanner.getLastError());
+  // Points at the separator
+  EXPECT_EQ(token.offset, 2u);
+}
+
+TEST(ScannerNumberTest, SeparatorBeforePointIsRejected) {
+  Scanner scanner("1_.5", "test.loom");
+  EXPECT_EQ(scanner.scanNextToken().type, TokenType::TOKEN_ERROR);
+}
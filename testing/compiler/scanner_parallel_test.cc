@@ -0,0 +1,107 @@
+// testing/compiler/scanner_parallel_test.cc
+//
+// scanParallel must produce exactly the tokens of a serial scan, wherever
+// the chunk cuts happen to land.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "scanner/scanner_internal.hh"
+#include "token_helpers.hh"
+
+// Strings and """ blocks spanning lines, comments holding quotes,
+// separated numbers and multi-byte UTF-8 inside and outside of literals
+static const char* const kMixedSource = R"LOOM(func main() i32 {
+    let s: string = "first line
+second line with a \" quote and a \\
+backslash, then an escaped \
+newline";
+    """ block comment
+    spanning // lines "with quotes"
+    """
+    // line comment with "quote and """ triple
+    // and one with an unmatched " quote
+    let big: i64 = 1_000_000;
+    let f: f64 = 3.141_592e-10;
+    let u: string = "grüße, 日本語, 🎉
+über";
+    let ä = 1;
+    $$print("done"); // ünïcödé
+    return 42;
+}
+)LOOM";
+
+// Scans every chunk on its own and joins them the way scanParallel does
+static std::vector<LoomToken> scanChunks(
+    std::string_view source, const std::vector<size_t>& boundaries) {
+  std::vector<LoomToken> tokens;
+  for (size_t i = 0; i < boundaries.size(); ++i) {
+    size_t end =
+        i + 1 < boundaries.size() ? boundaries[i + 1] : source.size();
+    for (LoomToken token :
+         scanAll(source.substr(boundaries[i], end - boundaries[i]))) {
+      token.offset += static_cast<uint32_t>(boundaries[i]);
+      tokens.push_back(token);
+    }
+    // Only the last chunk's EOF is the file's
+    if (i + 1 < boundaries.size()) tokens.pop_back();
+  }
+  return tokens;
+}
+
+// Tries every chunk size, so a nominal cut falls on every byte of source:
+// inside strings, """ blocks, comments, numbers and UTF-8 sequences
+static void expectEveryCutScansLikeSerial(std::string_view source) {
+  const std::vector<LoomToken> serial = scanAll(source);
+  for (size_t chunk_size = 1; chunk_size <= source.size(); ++chunk_size) {
+    SCOPED_TRACE("chunk size " + std::to_string(chunk_size));
+    std::vector<size_t> boundaries = findChunkBoundaries(source, chunk_size);
+    ASSERT_FALSE(boundaries.empty());
+    EXPECT_EQ(boundaries.front(), 0u);
+    for (size_t boundary : boundaries) {
+      if (boundary > 0) {
+        EXPECT_EQ(source[boundary - 1], '\n');
+      }
+    }
+    expectSameTokens(serial, scanChunks(source, boundaries));
+    if (testing::Test::HasFailure()) return;
+  }
+}
+
+TEST(ScannerParallelTest, EveryCutOfMixedSource) {
+  expectEveryCutScansLikeSerial(kMixedSource);
+}
+
+TEST(ScannerParallelTest, EveryCutWithUnterminatedString) {
+  expectEveryCutScansLikeSerial(
+      "let a = 1;\nlet s = \"never\nclosed\nlet b = 2;\nlet c = 3;\n");
+}
+
+TEST(ScannerParallelTest, EveryCutWithUnterminatedBlockComment) {
+  expectEveryCutScansLikeSerial(
+      "let a = 1;\n\"\"\" never\nclosed \"\"\nlet b = 2;\nlet c = 3;\n");
+}
+
+TEST(ScannerParallelTest, ScanParallelMatchesSerial) {
+  // Several MiB, so scanParallel really splits the source. The padding
+  // line varies so the cuts fall at different places of the fragment.
+  std::string source;
+  for (size_t i = 0; source.size() < (size_t{3} << 20); ++i) {
+    source += std::string(i % 11, ' ');
+    source += "\n";
+    source += kMixedSource;
+  }
+  // scanParallel doesn't cut below 1 MiB; make sure there is a cut
+  ASSERT_GT(findChunkBoundaries(source, size_t{1} << 20).size(), 1u);
+
+  const std::vector<LoomToken> serial = scanAll(source);
+  for (unsigned thread_count : {1u, 2u, 4u, 8u}) {
+    SCOPED_TRACE("threads " + std::to_string(thread_count));
+    expectSameTokens(serial,
+                     scanParallel(source, "test.loom", thread_count));
+  }
+}
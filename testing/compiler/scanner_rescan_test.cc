@@ -0,0 +1,90 @@
+// testing/compiler/scanner_rescan_test.cc
+//
+// rescanEdited must produce exactly the tokens of a full scan of the
+// edited source, whatever the edit does to the tokens around it.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "scanner/scanner_internal.hh"
+#include "token_helpers.hh"
+
+static const char* const kSource = R"LOOM(func main() i32 {
+    let s: string = "a string
+over two lines";
+    """ block
+    comment """
+    let x: f64 = 12.5e3 + 1_000; // trailing comment
+    $$print("ü");
+    return x;
+}
+)LOOM";
+
+// Applies edit to old_source and checks the rescan against a full scan
+static void expectRescanMatchesFullScan(const std::string& old_source,
+                                        size_t offset, size_t removed_length,
+                                        std::string_view inserted) {
+  std::string new_source = old_source;
+  new_source.replace(offset, removed_length, inserted);
+  SCOPED_TRACE("edit at " + std::to_string(offset) + " removing " +
+               std::to_string(removed_length) + " inserting \"" +
+               std::string(inserted) + "\"");
+
+  expectSameTokens(scanAll(new_source),
+                   rescanEdited(new_source, "test.loom", scanAll(old_source),
+                                SourceEdit{offset, removed_length, inserted}));
+}
+
+// Every offset of kSource, so each edit lands at the start, in the middle
+// and at the end of every kind of token
+static void expectEveryOffset(size_t removed_length,
+                              std::string_view inserted) {
+  const std::string source = kSource;
+  for (size_t offset = 0; offset + removed_length <= source.size();
+       ++offset) {
+    expectRescanMatchesFullScan(source, offset, removed_length, inserted);
+    if (testing::Test::HasFailure()) return;
+  }
+}
+
+TEST(ScannerRescanTest, OpeningAndClosingStrings) {
+  // A lone quote opens a string that runs until the next one, or closes
+  // the string the edit landed in
+  expectEveryOffset(0, "\"");
+  expectEveryOffset(1, "\"");
+  expectEveryOffset(0, "\\\"");
+}
+
+TEST(ScannerRescanTest, OpeningAndClosingBlockComments) {
+  expectEveryOffset(0, "\"\"\"");
+  expectEveryOffset(3, "");
+  expectEveryOffset(0, "//");
+}
+
+TEST(ScannerRescanTest, TokenBoundariesAtTheEdges) {
+  // Glues the edit to the tokens on either side (x1 -> ax1, 12.5 ->
+  // 12.55), splits them (a space or newline) or removes what separated
+  // two tokens
+  expectEveryOffset(0, "a");
+  expectEveryOffset(0, "5");
+  expectEveryOffset(0, " ");
+  expectEveryOffset(0, "\n");
+  expectEveryOffset(0, ".");
+  expectEveryOffset(0, "e");
+  expectEveryOffset(0, "_");
+  expectEveryOffset(1, "");
+  expectEveryOffset(2, "");
+  expectEveryOffset(1, "ü");
+}
+
+TEST(ScannerRescanTest, EditAtBothEnds) {
+  const std::string source = kSource;
+  expectRescanMatchesFullScan(source, 0, 0, "let a = 1;\n");
+  expectRescanMatchesFullScan(source, source.size(), 0, "\nlet a = 1;");
+  expectRescanMatchesFullScan(source, source.size(), 0, "\"unterminated");
+  expectRescanMatchesFullScan(source, 0, source.size(), "");
+  expectRescanMatchesFullScan("", 0, 0, source);
+}
@@ -0,0 +1,40 @@
+// testing/compiler/token_helpers.hh
+//
+// Scanning a whole source and comparing token lists, for the tests of the
+// scanner's parallel and incremental paths against a plain serial scan.
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "scanner/scanner_internal.hh"
+
+// Scans source with a single scanner, up to and including TOKEN_EOF
+inline std::vector<LoomToken> scanAll(std::string_view source) {
+  Scanner scanner(source, "test.loom");
+  std::vector<LoomToken> tokens;
+  for (;;) {
+    tokens.push_back(scanner.scanNextToken());
+    if (tokens.back().type == TokenType::TOKEN_EOF) break;
+  }
+  return tokens;
+}
+
+inline void expectSameTokens(const std::vector<LoomToken>& expected,
+                             const std::vector<LoomToken>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    SCOPED_TRACE("token " + std::to_string(i));
+    EXPECT_EQ(expected[i].offset, actual[i].offset);
+    EXPECT_EQ(static_cast<uint32_t>(expected[i].length),
+              static_cast<uint32_t>(actual[i].length));
+    EXPECT_EQ(static_cast<int>(expected[i].type),
+              static_cast<int>(actual[i].type));
+    // The whole payload: the value of a number, the symbol of a name
+    EXPECT_EQ(expected[i].int_value, actual[i].int_value);
+  }
+}